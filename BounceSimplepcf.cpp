@@ -89,3 +89,125 @@ bool BounceSimplePcf::readPins(uint8_t pin)
    }
   return (((~iRetValue) >> pin) & 0x01 ? true : false);	// since buttons are switch to GND, we invert the state
 }
+
+
+//=== BounceSimplePcfPort =====================================================
+BounceSimplePcfPort::BounceSimplePcfPort()
+    : previous_millis(0)
+    , sample_millis(4)
+    , state(0)
+    , changed(0)
+    , count0(0xff)
+    , count1(0xff)
+    , pcfAddress(0)
+{}
+
+void BounceSimplePcfPort::attach(uint8_t pcfAddress, uint16_t interval_millis) {
+    this->pcfAddress = pcfAddress;
+    interval(interval_millis);
+
+    state = readPort();
+    changed = 0;
+    count0 = count1 = 0xff;
+    previous_millis = (uint8_t)millis();
+}
+
+void BounceSimplePcfPort::interval(uint16_t interval_millis)
+{
+    // a change needs 4 equal samples, so the input is stable for 3..4 sample periods
+    uint16_t period = (interval_millis + 2) / 3;
+    if (period > 255)
+        period = 255;
+    sample_millis = period ? period : 1;
+}
+
+uint8_t BounceSimplePcfPort::update()
+{
+    changed = 0;
+    if ((uint8_t)((uint8_t)millis() - previous_millis) < sample_millis)
+        return 0;
+    previous_millis = (uint8_t)millis();
+
+    // bits that differ from the debounced state count down,
+    // all others reset their counter (2-bit vertical counter, 11 -> 10 -> 01 -> 00 -> 11)
+    uint8_t delta = state ^ readPort();
+    count0 = ~(count0 & delta);
+    count1 = count0 ^ (count1 & delta);
+    // counter rolled over: the input was stable long enough
+    delta &= count0 & count1;
+    state ^= delta;
+    changed = delta;
+
+    return changed;
+}
+
+uint8_t BounceSimplePcfPort::read()
+{
+    return state;
+}
+
+bool BounceSimplePcfPort::read(uint8_t pin)
+{
+    return (state >> pin) & 0x01;
+}
+
+bool BounceSimplePcfPort::rose(uint8_t pin)
+{
+    return ((state & changed) >> pin) & 0x01;
+}
+
+bool BounceSimplePcfPort::fell(uint8_t pin)
+{
+    return ((~state & changed) >> pin) & 0x01;
+}
+
+uint8_t BounceSimplePcfPort::readPort()
+{
+   register uint8_t iRetValue(0xff);
+   if(pcfAddress)
+   {
+     i2c_start(pcfAddress + 1);
+     iRetValue = i2c_readNAck();
+     i2c_stop();
+   }
+  return ~iRetValue;	// since buttons are switch to GND, we invert the state
+}
+
+//=== BounceSimplePcfPin ======================================================
+BounceSimplePcfPin::BounceSimplePcfPin(BounceSimplePcfPort &port, uint8_t pin)
+    : port(port)
+    , pin(pin)
+    , state(0)
+{}
+
+void BounceSimplePcfPin::attach(uint8_t pcfAddress, int pin, uint16_t interval_millis)
+{
+    port.attach(pcfAddress, interval_millis);
+    this->pin = pin;
+    // initial state is no change
+    follow();
+    state &= ~_BV(STATE_CHANGED);
+}
+
+bool BounceSimplePcfPin::follow()
+{
+    // compared with the state of the last update of this pin,
+    // so a change sampled by the update of another pin isn't lost
+    uint8_t current = port.read(pin) ? _BV(DEBOUNCED_STATE) : 0;
+    if ((state ^ current) & _BV(DEBOUNCED_STATE))
+        state = current | _BV(STATE_CHANGED);
+    else
+        state = current;
+
+    return state & _BV(STATE_CHANGED);
+}
+
+bool BounceSimplePcfPin::rose()
+{
+    return ( state & _BV(DEBOUNCED_STATE) ) && ( state & _BV(STATE_CHANGED));
+}
+
+bool BounceSimplePcfPin::fell()
+{
+    return !( state & _BV(DEBOUNCED_STATE) ) && ( state & _BV(STATE_CHANGED));
+}
@@ -65,4 +65,86 @@ class BounceSimplePcf
     uint8_t pcfAddress;
 };
 
+// Debounces all eight pins of a PCF8574 together:
+// the port is read once per sample and each pin is debounced by a
+// 2-bit vertical counter (4 equal samples are needed for a change)
+class BounceSimplePcfPort
+{
+ public:
+    // Create an instance of the bounce library
+    BounceSimplePcfPort();
+
+    // Attach to a PCF object (also sets initial state), and set debounce interval.
+    void attach(uint8_t pcfAddress, uint16_t interval_millis);
+
+    // Sets the debounce interval
+    void interval(uint16_t interval_millis);
+
+    // Updates all pins, the port is read at most once per sample period
+    // Returns a bitmask of the pins whose state changed
+    // Returns 0 if no state changed
+    uint8_t update();
+
+    // Returns the updated pin states (bit is set for each pin switched to GND)
+    uint8_t read();
+
+    // Returns the updated state of one pin
+    bool read(uint8_t pin);
+
+    // Returns the falling state of one pin
+    bool fell(uint8_t pin);
+
+    // Returns the rising state of one pin
+    bool rose(uint8_t pin);
+
+ protected:
+    uint8_t readPort();
+
+    uint8_t previous_millis;    // low byte of millis() is enough for the sample period
+    uint8_t sample_millis;
+    uint8_t state;
+    uint8_t changed;
+    uint8_t count0;             // vertical counter, bit 0
+    uint8_t count1;             // vertical counter, bit 1
+    uint8_t pcfAddress;
+};
+
+// Gives one pin of a BounceSimplePcfPort the interface of BounceSimplePcf,
+// the pin keeps the state of its last update, so pins can be updated one after the other
+class BounceSimplePcfPin
+{
+ public:
+    BounceSimplePcfPin(BounceSimplePcfPort &port, uint8_t pin);
+
+    // Attach to a PCF object (the port, for all pins), a pin (and also sets initial state),
+    // and set debounce interval, as attach() of BounceSimplePcf
+    void attach(uint8_t pcfAddress, int pin, uint16_t interval_millis);
+
+    // Sets the debounce interval (of the port, for all pins)
+    void interval(uint16_t interval_millis) { port.interval(interval_millis); }
+
+    // Updates the port (read at most once per sample period) and the pin
+    // Returns 1 if the state changed since the last update of the pin
+    // Returns 0 if the state did not change
+    bool update() { port.update(); return follow(); }
+
+    // Updates the pin from the port without reading it, e.g. after update() of the port
+    // Returns 1 if the state changed since the last update of the pin
+    bool follow();
+
+    // Returns the updated pin state
+    bool read() { return port.read(pin); }
+
+    // Returns the falling pin state (of the last update of the pin)
+    bool fell();
+
+    // Returns the rising pin state (of the last update of the pin)
+    bool rose();
+
+ protected:
+    BounceSimplePcfPort &port;
+    uint8_t pin;
+    uint8_t state;
+};
+
 #endif
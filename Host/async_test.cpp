@@ -0,0 +1,178 @@
+/*
+ *  async_test.cpp
+ *
+ *  queued transmission (I2C_ASYNC) with deferred TWI-interrupts at the
+ *  emulated TWI: lcd_clrscr() fits the queue, a full queue waits for the
+ *  interrupt, i2c_flush() and a stop-condition not done reset the queue
+ *  when the bus is held, segments of a transmission without ACK are
+ *  discarded, i2c_onIdle() is called once at the end, a paused
+ *  transmission is continued by more data
+ *
+ *  build: ASYNC=1 Host/build.sh Host/async_test.cpp
+ *  usage: Host/build/async_test      exit code 1 if a check fails
+ */
+#include <Arduino.h>
+#include "OLEDPanel.h"
+#include "twi_emu.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if !defined I2C_ASYNC
+#error "build with ASYNC=1"
+#endif
+
+#define MISSING_ADDR (0x50 << 1)	// no device at the bus
+
+static int failures;
+static uint8_t data[100];
+static volatile int idleCalls;
+
+static void check(bool ok, const char *name)
+{
+	printf("%s\t%s\n", ok ? "ok" : "FAIL", name);
+	if (!ok)
+		failures++;
+}
+
+// display initialized, interrupts deferred from now on
+static void start()
+{
+	TwiEmu::reset();
+	TwiEmu::displayAddress = LCD_I2C_ADR;
+	i2c_setOnline(LCD_I2C_ADR << 1);
+	lcd_init(LCD_DISP_ON);
+	i2c_flush();
+	I2C_ErrorCode = 0;
+	TwiEmu::resetStats();
+	TwiEmu::deferInterrupts = true;
+}
+
+static bool queueError()
+{
+	return I2C_ErrorCode & (1 << I2C_QUEUE);
+}
+
+// size bytes of data at column 0 of page in display ram
+static bool ramHolds(uint8_t page, uint8_t size)
+{
+	return !memcmp(&TwiEmu::display.ram[page][2], data, size);
+}
+
+static void onIdle()
+{
+	idleCalls++;
+}
+
+int main()
+{
+	for (uint8_t i = 0; i < sizeof(data); i++)
+		data[i] = i * 3 + 1;
+
+	// lcd_clrscr() is queued at once, nothing is send before it returns
+	start();
+	lcd_clrscr();
+	check(TwiEmu::stats.bytes == 0 && i2c_busy() && !queueError(), "clrscr_fits_queue");
+	i2c_flush();
+	check(TwiEmu::stats.stops == DISPLAY_HEIGHT/8 && TwiEmu::display.dataBytes == DISPLAY_HEIGHT/8 * DISPLAY_WIDTH,
+	      "clrscr_send");
+
+	// second lcd_clrscr() waits for free segments, the interrupt runs meanwhile
+	start();
+	lcd_clrscr();
+	lcd_clrscr();
+	check(TwiEmu::stats.bytes > 0 && !queueError(), "queue_full_segments_waits");
+	i2c_flush();
+	check(TwiEmu::stats.stops == DISPLAY_HEIGHT/4 && TwiEmu::display.dataBytes == DISPLAY_HEIGHT/4 * DISPLAY_WIDTH,
+	      "queue_full_segments_send");
+
+	// more copied bytes than I2C_QUEUE_BYTES
+	start();
+	lcd_gotoxy(0, 2);
+	lcd_data(data, sizeof(data));
+	check(TwiEmu::stats.bytes > 0 && !queueError(), "queue_full_bytes_waits");
+	i2c_flush();
+	check(ramHolds(2, sizeof(data)) && !queueError(), "queue_full_bytes_send");
+
+	// no ACK for adress: rest of that transmission is discarded, next one is send
+	start();
+	i2c_queueStart(MISSING_ADDR);
+	i2c_queueByte(0x40);
+	i2c_queueData(data, 3);
+	i2c_queueStop();
+	lcd_gotoxy(0, 1);
+	lcd_data(data, 8);
+	i2c_flush();
+	// adress of both, adressing commands with control bytes, control byte, data
+	unsigned long ulBytes(2 + 2 * TwiEmu::display.commands + 1 + 8);
+	check(TwiEmu::stats.nacks == 1 && TwiEmu::stats.bytes == ulBytes && i2c_failed(MISSING_ADDR) == 1,
+	      "nack_discards_transmission");
+	check(ramHolds(1, 8) && TwiEmu::stats.stops == 2, "nack_next_transmission_send");
+
+	// i2c_onIdle(): called once when the queue is done
+	start();
+	idleCalls = 0;
+	i2c_onIdle(onIdle);
+	lcd_gotoxy(0, 3);
+	lcd_data(data, 4);
+	lcd_gotoxy(0, 4);
+	lcd_data(data, 4);
+	bool bEarly(false);
+	while (TwiEmu::step())
+		if (i2c_busy() && idleCalls)
+			bEarly = true;
+	check(!bEarly && idleCalls == 1 && !i2c_busy(), "on_idle_once_at_end");
+	i2c_onIdle(0);
+
+	// transmission without stop-condition pauses and holds the bus,
+	// i2c_queueByte() continues it
+	start();
+	lcd_gotoxy(0, 5);
+	lcd_data_start();
+	i2c_queueByte(data[0]);
+	i2c_queueByte(data[1]);
+	while (TwiEmu::step())
+		;
+	check(i2c_busy() && TwiEmu::display.dataBytes == 2 && TwiEmu::stats.stops == 0, "paused_holds_bus");
+	i2c_queueByte(data[2]);
+	i2c_queueStop();
+	i2c_flush();
+	check(ramHolds(5, 3) && TwiEmu::stats.starts == 1 && TwiEmu::stats.stops == 1, "paused_continued");
+
+	// bus held: i2c_flush() runs out of time and resets the queue
+	start();
+	TwiEmu::busHeld = true;
+	lcd_gotoxy(0, 6);
+	lcd_data(data, 4);
+	i2c_flush();
+	check(!i2c_busy() && queueError() && i2c_failed(LCD_I2C_ADR << 1) == 1, "flush_timeout_reset");
+	TwiEmu::busHeld = false;
+	I2C_ErrorCode = 0;
+	lcd_gotoxy(0, 6);
+	lcd_data(data, 4);
+	i2c_flush();
+	check(ramHolds(6, 4) && !I2C_ErrorCode && i2c_failed(LCD_I2C_ADR << 1) == 0, "flush_timeout_recovered");
+
+	// stop-condition not done: next start-condition resets the queue
+	start();
+	lcd_gotoxy(0, 7);
+	lcd_data(data, 1);
+	while (TwiEmu::display.dataBytes == 0 && TwiEmu::step())
+		;
+	TwiEmu::busHeld = true;
+	TwiEmu::step();
+	uint8_t ui8Failures(i2c_failures());
+	lcd_gotoxy(0, 7);
+	lcd_data(data + 1, 1);
+	check(TwiEmu::stats.stops == 0 && !i2c_busy() && queueError() && i2c_failures() == ui8Failures + 1,
+	      "stop_held_reset");
+	TwiEmu::busHeld = false;
+	I2C_ErrorCode = 0;
+	lcd_gotoxy(0, 7);
+	lcd_data(data, 4);
+	i2c_flush();
+	check(ramHolds(7, 4) && !I2C_ErrorCode, "stop_held_recovered");
+
+	printf("%d failure(s)\n", failures);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,96 @@
+/*
+ *  bands_bench.cpp
+ *
+ *  the same scene of graphic and text drawn by lcd_drawBands() (GRAPHICBANDS,
+ *  one page of SRAM) or into the buffer and send by lcd_display() (GRAPHICMODE),
+ *  prints the bus traffic and writes the display content as PBM image,
+ *  with a reference image (of the other mode) both must match pixel by pixel
+ *
+ *  build: GRAPHIC=1 Host/build.sh Host/bands_bench.cpp   or
+ *         BANDS=1 Host/build.sh Host/bands_bench.cpp
+ *  usage: Host/build/bands_bench scene.pbm [reference.pbm]
+ *                                        exit code 1 if the images differ
+ */
+#include <Arduino.h>
+#include "OLEDPanel.h"
+#include "twi_emu.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if !defined GRAPHICMODE && !defined GRAPHICBANDS
+#error "build with GRAPHIC=1 or BANDS=1"
+#endif
+
+#define PBM_SIZE 8192	// "P1\n128 64\n" and 64 lines of 129 characters
+
+static void drawScene()
+{
+	lcd_drawRect(0, 0, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1, WHITE);
+	lcd_drawLine(0, DISPLAY_HEIGHT - 1, DISPLAY_WIDTH - 1, 0, WHITE);
+	lcd_drawCircle(96, 32, 24, WHITE);
+	lcd_fillCircle(96, 32, 18, WHITE);
+	lcd_fillRoundRect(8, 40, 60, 58, 5, WHITE);
+	lcd_fillRect(14, 45, 30, 52, BLACK);
+	lcd_drawHLine(4, 60, 36, WHITE);
+	lcd_drawVLine(64, 4, 59, WHITE);
+	lcd_gotoxy(1, 1);
+	lcd_puts("Bands");
+	lcd_charMode(INVERT);
+	lcd_gotoxy(1, 3);
+	lcd_puts("inverted");
+	lcd_charMode(NORMALSIZE);
+}
+
+static bool readFile(const char *fileName, char *pText, size_t size)
+{
+	FILE *f(fopen(fileName, "r"));
+	if (!f)
+		return false;
+	size_t n(fread(pText, 1, size - 1, f));
+	pText[n] = '\0';
+	fclose(f);
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 2)
+	{
+		printf("usage: %s scene.pbm [reference.pbm]\n", argv[0]);
+		return 2;
+	}
+	TwiEmu::reset();
+	lcd_init(LCD_DISP_ON);
+	i2c_flush();
+	TwiEmu::resetStats();
+#if defined GRAPHICMODE
+	const char *pMode("lcd_display");
+	drawScene();
+	lcd_display();
+#else
+	const char *pMode("lcd_drawBands");
+	lcd_drawBands(drawScene);
+#endif
+	i2c_flush();
+	printf("# mode\tbytes\tstarts\tstops\tus@400kHz\n");
+	printf("%s\t%lu\t%lu\t%lu\t%.0f\n", pMode, TwiEmu::stats.bytes, TwiEmu::stats.starts,
+	       TwiEmu::stats.stops, TwiEmu::stats.micros(400000UL));
+
+	if (!TwiEmu::display.writePBM(argv[1]))
+	{
+		printf("can't write %s\n", argv[1]);
+		return 2;
+	}
+	if (argc < 3)
+		return 0;
+	static char scene[PBM_SIZE], reference[PBM_SIZE];
+	if (!readFile(argv[1], scene, sizeof(scene)) || !readFile(argv[2], reference, sizeof(reference)))
+	{
+		printf("can't read %s\n", argv[2]);
+		return 2;
+	}
+	bool bSame(!strcmp(scene, reference));
+	printf("%s\t%s\n", bSame ? "SAME" : "DIFFERENT", argv[2]);
+	return bSame ? 0 : 1;
+}
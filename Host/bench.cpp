@@ -0,0 +1,250 @@
+/*
+ *  bench.cpp
+ *
+ *  bus traffic of the OLEDPanel API at the emulated TWI,
+ *  prints a table (tab separated) with bytes, start- and stop-conditions
+ *  and wire time at 100 and 400 kHz for each workload
+ *
+ *  build: Host/build.sh Host/bench.cpp
+ *  usage: Host/build/bench                      print table
+ *         Host/build/bench baseline.txt         compare with baseline,
+ *                                               exit code 1 at regression
+ *         Host/build/bench --update baseline.txt  write new baseline
+ *
+ *  baseline at introduction of the benchmark (TEXTMODE, SH1106): Host/bench_baseline.txt,
+ *  updated where later changes lowered a value or added workloads
+ */
+#include <Arduino.h>
+#include "OLEDPanel.h"
+#include "twi_emu.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static OLEDPanel oled;
+static OLEDShadow shadow;
+static OLEDField field(7, 3, 6);
+static uint8_t snapshot[SNAPSHOT_SIZE(12, 5)];
+
+struct Result {
+	char name[32];
+	unsigned long bytes;
+	unsigned long starts;
+	unsigned long stops;
+};
+
+#define MAX_RESULTS 48
+static Result results[MAX_RESULTS];
+static uint8_t resultCount;
+
+static void shadowScreen(unsigned long value)
+{
+	oled.clear();
+	oled.printc(0, F("Status"));
+	oled.setCursor(0, 2);
+	oled.print(F("Speed:"));
+	oled.printc(7, 2, value, DEC);
+	oled.setCharMode(false, true, false);
+	oled.setCursor(0, 4);
+	oled.print(F("inverted"));
+	oled.setCharMode(false, false, false);
+	oled.flush();
+}
+
+// workloads, measured one after the other at the same panel
+static void runWorkload(uint8_t i)
+{
+	switch (i)
+	{
+		case 0: lcd_init(LCD_DISP_ON); break;
+		case 1: oled.begin(); break;
+		case 2: oled.setCursor(0, 0); oled.print("Hello, world!"); break;
+		case 3: oled.setCursor(0, 1); oled.print(F("Hello, flash!")); break;
+		case 4: oled.setCursor(0, 2); oled.print(String("Hello, String!")); break;
+		case 5: oled.print(20, 7, 'X'); break;
+		case 6: oled.setCursor(0, 3); oled.print((uint16_t)12345, DEC); break;
+		case 7: oled.setCursor(0, 4); oled.print(0xC0FFEEUL, HEX); break;
+		case 8: oled.printc(5, "centered"); break;
+		case 9: oled.printc(255, 6, 4711UL, DEC); break;
+		case 10: oled.printr(7, 0, F("right")); break;
+		case 11:
+			oled.setCharMode(true, false, false);
+			oled.setCursor(0, 3);
+			oled.print("12:34");
+			oled.setCharMode(false, false, false);
+			break;
+		case 12:
+			oled.setCharMode(false, true, true);
+			oled.setCursor(0, 0);
+			oled.print("invert+underline");
+			oled.setCharMode(false, false, false);
+			break;
+		case 13: oled.clear(5, 2, 6); break;
+		case 14: oled.clearLine(3); break;
+		case 15: oled.clearToEOL(10, 4); break;
+		case 16: oled.cursor(3, 3); break;
+		case 17: oled.cursor(4, 3); break;
+		case 18: oled.cursor(4, 3); break;
+		case 19:
+			// one phase of blinking
+			TwiEmu::advance((CURSOR_BLINK_TIME + 1) * 1000UL);
+			oled.refresh();
+			break;
+		case 20: oled.noCursor(); break;
+		case 21: oled.printOuterFrame(); break;
+		case 22: oled.clear(); break;
+		case 23: oled.readButtons(); break;
+		case 24: oled.setShadow(&shadow); shadowScreen(100); break;
+		case 25: shadowScreen(100); break;
+		case 26: shadowScreen(101); break;
+		case 27: oled.setShadow(0); break;
+		// Print::print/println through write()
+		case 28: oled.setCursor(0, 5); oled.print(-4711); break;
+		case 29: oled.setCursor(0, 6); oled.print(3.14159, 3); break;
+		case 30: oled.setCursor(0, 6); oled.println(42); break;
+		case 31: field.update(12345UL); break;
+		case 32: field.update(12345UL); break;
+		case 33: field.update(12346UL); break;
+		// menu over the status screen, closed by restoring the region below
+		case 34: oled.setShadow(&shadow); shadowScreen(100); break;
+		case 35: oled.saveRegion(4, 1, 12, 5, snapshot); break;
+		case 36:
+			for (uint8_t y = 1; y < 6; y++)
+				oled.clear(4, y, 12);
+			oled.setCursor(5, 2);
+			oled.print(F("Settings"));
+			oled.setCursor(5, 3);
+			oled.print(F("Back"));
+			oled.flush();
+			break;
+		case 37: oled.restoreRegion(4, 1, 12, 5, snapshot); oled.flush(); break;
+		case 38: oled.setShadow(0); break;
+		// console at the last line: one new line each
+		case 39: oled.setConsole(true); oled.setCursor(0, 7); oled.println("console"); break;
+		case 40: oled.println("console"); break;
+		case 41: oled.setShadow(&shadow); oled.setCursor(0, 7); break;
+		case 42: oled.println("console"); oled.flush(); break;
+		case 43: oled.println("console"); oled.flush(); break;
+		case 44: oled.setShadow(0); oled.setConsole(false); break;
+		default: break;
+	}
+}
+
+static const char *workloadName[] = {
+	"lcd_init", "begin", "print_ram", "print_flash", "print_String",
+	"print_xy_char", "print_uint16", "print_hex", "printc", "printc_number",
+	"printr", "print_double", "print_invert", "clear_part", "clearLine",
+	"clearToEOL", "cursor", "cursor_move", "cursor_repeat", "cursor_blink", "noCursor", "printOuterFrame", "clear",
+	"readButtons", "shadow_first", "shadow_repeat", "shadow_digit", "shadow_off",
+	"print_int", "print_float", "println_int",
+	"field_first", "field_repeat", "field_digit",
+	"menu_screen", "region_save", "menu_open", "region_restore", "menu_shadow_off",
+	"console_line", "console_next_line", "console_shadow_on", "console_shadow_line",
+	"console_shadow_next_line", "console_off",
+};
+
+static void measure()
+{
+	TwiEmu::reset();
+	oled.detect_i2c(0x21 << 1);
+	for (uint8_t i = 0; i < sizeof(workloadName) / sizeof(workloadName[0]); i++)
+	{
+		i2c_flush();
+		TwiEmu::resetStats();
+		runWorkload(i);
+		i2c_flush();
+		Result &r(results[resultCount++]);
+		strncpy(r.name, workloadName[i], sizeof(r.name) - 1);
+		r.bytes = TwiEmu::stats.bytes;
+		r.starts = TwiEmu::stats.starts;
+		r.stops = TwiEmu::stats.stops;
+	}
+}
+
+static double wireMicros(const Result &r, unsigned long f_i2c)
+{
+	// 9 clocks per byte, one for each start- and stop-condition
+	return (r.bytes * 9.0 + r.starts + r.stops) * 1e6 / f_i2c;
+}
+
+static void printTable(FILE *f)
+{
+	fprintf(f, "# api\tbytes\tstarts\tstops\tus@100kHz\tus@400kHz\n");
+	for (uint8_t i = 0; i < resultCount; i++)
+	{
+		const Result &r(results[i]);
+		fprintf(f, "%s\t%lu\t%lu\t%lu\t%.0f\t%.0f\n", r.name, r.bytes, r.starts, r.stops,
+		        wireMicros(r, 100000UL), wireMicros(r, 400000UL));
+	}
+}
+
+// returns count of regressions, missing entries count as regression
+static int compare(FILE *f)
+{
+	int regressions(0);
+	bool found[MAX_RESULTS] = { false };
+	char line[128];
+	while (fgets(line, sizeof(line), f))
+	{
+		Result base;
+		if (line[0] == '#' || sscanf(line, "%31s %lu %lu %lu", base.name, &base.bytes, &base.starts, &base.stops) != 4)
+			continue;
+		uint8_t i(0);
+		while (i < resultCount && strcmp(results[i].name, base.name))
+			i++;
+		if (i == resultCount)
+		{
+			printf("MISSING\t%s\n", base.name);
+			regressions++;
+			continue;
+		}
+		found[i] = true;
+		const Result &r(results[i]);
+		if (r.bytes > base.bytes || r.starts > base.starts || r.stops > base.stops)
+		{
+			printf("REGRESSION\t%s\tbytes %lu -> %lu\tstarts %lu -> %lu\tstops %lu -> %lu\n", r.name,
+			       base.bytes, r.bytes, base.starts, r.starts, base.stops, r.stops);
+			regressions++;
+		}
+		else if (r.bytes < base.bytes || r.starts < base.starts || r.stops < base.stops)
+			printf("BETTER\t%s\tbytes %lu -> %lu\tstarts %lu -> %lu\tstops %lu -> %lu\n", r.name,
+			       base.bytes, r.bytes, base.starts, r.starts, base.stops, r.stops);
+	}
+	for (uint8_t i = 0; i < resultCount; i++)
+		if (!found[i])
+			printf("NEW\t%s\n", results[i].name);
+	return regressions;
+}
+
+int main(int argc, char *argv[])
+{
+	measure();
+	printTable(stdout);
+
+	if (argc == 3 && !strcmp(argv[1], "--update"))
+	{
+		FILE *f(fopen(argv[2], "w"));
+		if (!f)
+		{
+			printf("can't write %s\n", argv[2]);
+			return 2;
+		}
+		printTable(f);
+		fclose(f);
+		return 0;
+	}
+	if (argc == 2)
+	{
+		FILE *f(fopen(argv[1], "r"));
+		if (!f)
+		{
+			printf("can't read %s\n", argv[1]);
+			return 2;
+		}
+		int regressions(compare(f));
+		fclose(f);
+		printf("%d regression(s)\n", regressions);
+		return regressions ? 1 : 0;
+	}
+	return 0;
+}
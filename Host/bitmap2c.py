@@ -0,0 +1,200 @@
+#!/usr/bin/env python3
+#
+#  bitmap2c.py
+#
+#  converts a PBM or PNG image into a C array in page format of the display
+#  for lcd_drawPageBitmap() and lcd_putBitmap(): (height+7)/8 rows of width
+#  bytes, bit 0 is the top pixel of each byte
+#
+#  usage: Host/bitmap2c.py [-n name] [-i] [-p] image.pbm|image.png [output.h]
+#
+#  PBM: pixels 1 (black) are set
+#  PNG: dark pixels are set, transparent pixels are clear
+#  -i   invert the image
+#  -p   run-length coded for lcd_putPackedBitmap(): width, pages, then runs
+#       of each page, control byte 0..127: 1..128 bytes follow,
+#       128..255: next byte (control & 0x7f) + 3 times
+#
+import os
+import struct
+import sys
+import zlib
+
+
+def read_pbm(data):
+    # header tokens, comments start with '#'
+    tokens, pos = [], 0
+    while len(tokens) < 3:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b'#':
+            pos = data.index(b'\n', pos)
+            continue
+        start = pos
+        while not data[pos:pos + 1].isspace():
+            pos += 1
+        tokens.append(data[start:pos])
+    magic, width, height = tokens[0], int(tokens[1]), int(tokens[2])
+    if magic == b'P4':
+        pos += 1
+        stride = (width + 7) // 8
+        return width, height, [[(data[pos + y * stride + x // 8] >> (7 - x % 8)) & 1
+                                for x in range(width)] for y in range(height)]
+    if magic == b'P1':
+        bits = [c - ord('0') for c in data[pos:] if c in b'01']
+        return width, height, [bits[y * width:(y + 1) * width] for y in range(height)]
+    raise ValueError('no PBM (P1/P4)')
+
+
+def read_png(data):
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        raise ValueError('no PNG')
+    pos, idat, palette, alpha = 8, b'', [], []
+    while pos < len(data):
+        length, kind = struct.unpack('>I4s', data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b'IHDR':
+            width, height, depth, color, _, _, interlace = struct.unpack('>IIBBBBB', chunk)
+        elif kind == b'PLTE':
+            palette = [tuple(chunk[i:i + 3]) for i in range(0, length, 3)]
+        elif kind == b'tRNS':
+            alpha = list(chunk)
+        elif kind == b'IDAT':
+            idat += chunk
+    if interlace:
+        raise ValueError('interlaced PNG')
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[color]
+    if depth != 8 and color not in (0, 3):
+        raise ValueError('PNG with %d bits per channel' % depth)
+    bpp = max(1, channels * depth // 8)
+    stride = (width * channels * depth + 7) // 8
+    raw = zlib.decompress(idat)
+    prior, image = bytearray(stride), []
+    for y in range(height):
+        kind, line = raw[y * (stride + 1)], bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for i in range(stride):
+            a = line[i - bpp] if i >= bpp else 0
+            b = prior[i]
+            c = prior[i - bpp] if i >= bpp else 0
+            if kind == 1:
+                line[i] = (line[i] + a) & 0xff
+            elif kind == 2:
+                line[i] = (line[i] + b) & 0xff
+            elif kind == 3:
+                line[i] = (line[i] + (a + b) // 2) & 0xff
+            elif kind == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                line[i] = (line[i] + (a if pa <= pb and pa <= pc else b if pb <= pc else c)) & 0xff
+        prior = line
+        row = []
+        for x in range(width):
+            if depth < 8:
+                v = (line[x * depth // 8] >> (8 - depth - x * depth % 8)) & ((1 << depth) - 1)
+                px = [v]
+            else:
+                px = list(line[x * channels:(x + 1) * channels])
+            if color == 3:
+                r, g, b = palette[px[0]]
+                a = alpha[px[0]] if px[0] < len(alpha) else 255
+            elif color in (0, 4):
+                r = g = b = px[0] * 255 // ((1 << depth) - 1)
+                a = px[1] if color == 4 else 255
+            else:
+                r, g, b = px[:3]
+                a = px[3] if color == 6 else 255
+            row.append(1 if a >= 128 and (r * 299 + g * 587 + b * 114) < 128000 else 0)
+        image.append(row)
+    return width, height, image
+
+
+def page_format(width, height, image):
+    data = []
+    for page in range((height + 7) // 8):
+        for x in range(width):
+            byte = 0
+            for bit in range(8):
+                y = page * 8 + bit
+                if y < height and image[y][x]:
+                    byte |= 1 << bit
+            data.append(byte)
+    return data
+
+
+def pack(width, data):
+    # runs don't cross pages, so each page is decoded on its own
+    packed = [width, len(data) // width]
+    for start in range(0, len(data), width):
+        page, literal, i = data[start:start + width], [], 0
+
+        def flush():
+            for j in range(0, len(literal), 128):
+                packed.append(len(literal[j:j + 128]) - 1)
+                packed.extend(literal[j:j + 128])
+            del literal[:]
+        while i < width:
+            count = 1
+            while i + count < width and count < 130 and page[i + count] == page[i]:
+                count += 1
+            if count >= 3:
+                flush()
+                packed.extend([0x80 | (count - 3), page[i]])
+                i += count
+            else:
+                literal.append(page[i])
+                i += 1
+        flush()
+    return packed
+
+
+def main(argv):
+    name, invert, packed, args = None, False, False, []
+    i = 1
+    while i < len(argv):
+        if argv[i] == '-n' and i + 1 < len(argv):
+            name = argv[i + 1]
+            i += 1
+        elif argv[i] == '-i':
+            invert = True
+        elif argv[i] == '-p':
+            packed = True
+        else:
+            args.append(argv[i])
+        i += 1
+    if not args:
+        print('usage: bitmap2c.py [-n name] [-i] [-p] image.pbm|image.png [output.h]')
+        return 2
+    with open(args[0], 'rb') as f:
+        data = f.read()
+    width, height, image = (read_png if data[:4] == b'\x89PNG' else read_pbm)(data)
+    if invert:
+        image = [[1 - v for v in row] for row in image]
+    if width > 255 or height > 255:
+        print('image larger than 255 pixels')
+        return 1
+    name = name or os.path.splitext(os.path.basename(args[0]))[0].replace('-', '_')
+    data = page_format(width, height, image)
+    lines = ['// %s: %d x %d pixels, page format for lcd_drawPageBitmap()' % (os.path.basename(args[0]), width, height),
+             '#define %s_WIDTH %d' % (name.upper(), width),
+             '#define %s_HEIGHT %d' % (name.upper(), height)]
+    step = width if width <= 16 else 16
+    if packed:
+        raw, data, step = len(data), pack(width, data), 16
+        lines[0] = '// %s: %d x %d pixels, %d of %d bytes, run-length coded for lcd_putPackedBitmap()' % (
+            os.path.basename(args[0]), width, height, len(data), raw)
+    lines.append('const uint8_t %s[] PROGMEM = {' % name)
+    for i in range(0, len(data), step):
+        lines.append('\t' + ', '.join('0x%02X' % b for b in data[i:i + step]) + ',')
+    lines.append('};')
+    text = '\n'.join(lines) + '\n'
+    if len(args) > 1:
+        with open(args[1], 'w') as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,43 @@
+#!/bin/sh
+#
+#  build.sh
+#
+#  builds a host program with the library and the TWI emulation
+#  (SH1106 display and PCF8574 buttons, refer twi_emu.h)
+#
+#  usage: Host/build.sh program.cpp
+#         binary is Host/build/program
+#
+#  GRAPHIC=1  library in GRAPHICMODE (default: TEXTMODE as set in lcd.h)
+#  ASYNC=1    library with I2C_ASYNC (default: blocking as set in i2c.h)
+#  BANDS=1    library with GRAPHICBANDS (TEXTMODE)
+#
+set -e
+HOST=$(cd "$(dirname "$0")" && pwd)
+LIB=$(dirname "$HOST")
+OUT=$HOST/build
+SRC=$OUT/src
+PROGRAM=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+NAME=$(basename "$1" .cpp)
+CC=${CC:-gcc}
+CXX=${CXX:-g++}
+
+# copy of the library, includes are written as "utility\lcd.h"
+rm -rf "$SRC"
+mkdir -p "$SRC"
+cp "$LIB"/*.cpp "$LIB"/*.h "$SRC"/
+cp -r "$LIB"/utility "$SRC"/
+sed -i 's/utility\\/utility\//' "$SRC"/*.cpp "$SRC"/*.h
+[ -n "$GRAPHIC" ] && sed -i 's/^#define TEXTMODE/#define GRAPHICMODE/' "$SRC"/utility/lcd.h
+[ -n "$ASYNC" ] && sed -i 's/^\/\/#define I2C_ASYNC/#define I2C_ASYNC/' "$SRC"/utility/i2c.h
+[ -n "$BANDS" ] && sed -i 's/^\/\/#define GRAPHICBANDS/#define GRAPHICBANDS/' "$SRC"/utility/lcd.h
+
+FLAGS="-DARDUINO=10800 -I$HOST/stubs -I$HOST -I$SRC -Wall -Wno-unknown-pragmas -g $EXTRA"
+CXXFLAGS="$FLAGS -std=gnu++11"
+cd "$OUT"
+# the TWI registers are C++ objects (refer stubs/avr/io.h), so i2c.c is C++ here
+$CXX $CXXFLAGS -Wno-narrowing -x c++ -c "$SRC"/utility/i2c.c -o i2c.o
+$CC $FLAGS -c "$SRC"/utility/lcd.c -o lcd.o
+$CC $FLAGS -c "$SRC"/utility/font.c -o font.o
+$CXX $CXXFLAGS -o "$NAME" "$PROGRAM" "$SRC"/*.cpp "$HOST"/twi_emu.cpp "$HOST"/stubs/Print.cpp i2c.o lcd.o font.o
+echo "$OUT/$NAME"
@@ -0,0 +1,162 @@
+/*
+ *  debounce_test.cpp
+ *
+ *  debouncing of the buttons (BounceSimplePcfPort, 2-bit vertical counters)
+ *  with bouncing input scripted at the emulated PCF8574: each press and
+ *  release is reported once and after the debounce time, the PCF8574 is read
+ *  once per sample for all buttons, pins updated one after the other keep
+ *  their changes (debouncer_... of OLEDPanel), attach() of a pin works as at
+ *  BounceSimplePcf
+ *
+ *  build: Host/build.sh Host/debounce_test.cpp
+ *  usage: Host/build/debounce_test      exit code 1 if a check fails
+ */
+#include <Arduino.h>
+#include "OLEDPanel.h"
+#include "twi_emu.h"
+
+#include <stdio.h>
+
+#define PCF8574_ADDR (0x21 << 1)
+#define STEP_US 250		// loop of the sketch
+
+static OLEDPanel oled;
+static int failures;
+
+static void check(bool ok, const char *name)
+{
+	printf("%s\t%s\n", ok ? "ok" : "FAIL", name);
+	if (!ok)
+		failures++;
+}
+
+static unsigned long t0;	// ms, start of the script
+
+struct Events {
+	unsigned rose;
+	unsigned fell;
+	unsigned long firstRose;	// ms from t0
+	unsigned long firstFell;
+};
+
+static void count(Events &e, bool rose, bool fell)
+{
+	if (rose && !e.rose++)
+		e.firstRose = millis() - t0;
+	if (fell && !e.fell++)
+		e.firstFell = millis() - t0;
+}
+
+// buttons bounce for 6 ms from the given time (ms) on, then they are stable
+#define BOUNCE_TIME 6
+static void bounce(unsigned long ms, uint8_t pressed, uint8_t released)
+{
+	ms += t0;
+	TwiEmu::scriptButtons(ms, pressed);
+	TwiEmu::scriptButtons(ms + 1, released);
+	TwiEmu::scriptButtons(ms + 3, pressed);
+	TwiEmu::scriptButtons(ms + 4, released);
+	TwiEmu::scriptButtons(ms + BOUNCE_TIME, pressed);
+}
+
+static void startScript()
+{
+	TwiEmu::reset();
+	oled.detect_i2c(PCF8574_ADDR);
+	oled.begin();
+	t0 = millis();
+}
+
+// buttons pressed from 100 to 300 ms, both edges bouncing,
+// a spike of 1 ms at 400 ms
+static void pressAndRelease(uint8_t buttons)
+{
+	startScript();
+	bounce(100, buttons, 0);
+	bounce(300, 0, buttons);
+	TwiEmu::scriptButtons(t0 + 400, buttons);
+	TwiEmu::scriptButtons(t0 + 401, 0);
+}
+
+int main()
+{
+	// updateDebounce() in the loop, queries of the pin and of the port
+	pressAndRelease(BUTTON_SELECT);
+	Events pin = Events(), port = Events();
+	unsigned long reads(TwiEmu::keypad.reads);
+	while (millis() < t0 + 500)
+	{
+		oled.updateDebounce();
+		count(pin, oled.debouncer_OK.rose(), oled.debouncer_OK.fell());
+		count(port, oled.debouncer.rose(0), oled.debouncer.fell(0));
+		TwiEmu::advance(STEP_US);
+	}
+	reads = TwiEmu::keypad.reads - reads;
+	printf("# updateDebounce: press at %lu ms, release at %lu ms, %lu reads in %lu ms\n",
+	       pin.firstRose, pin.firstFell, reads, millis() - t0);
+	check(pin.rose == 1 && pin.fell == 1, "updateDebounce_one_press_one_release");
+	check(pin.firstRose >= 100 + BOUNCE_TIME + DEBOUNCE_TIME && pin.firstRose <= 100 + BOUNCE_TIME + 2 * DEBOUNCE_TIME, "updateDebounce_press_after_debounce_time");
+	check(pin.firstFell >= 300 + BOUNCE_TIME + DEBOUNCE_TIME && pin.firstFell <= 300 + BOUNCE_TIME + 2 * DEBOUNCE_TIME, "updateDebounce_release_after_debounce_time");
+	check(port.rose == 1 && port.fell == 1 && port.firstRose == pin.firstRose, "updateDebounce_port_queries");
+	check(!oled.debouncer_OK.read(), "updateDebounce_spike_ignored");
+	// DEBOUNCE_TIME 5: sample every 2 ms
+	check(reads <= (millis() - t0) / 2 + 1, "updateDebounce_one_read_per_sample");
+
+	// update() of two pins one after the other, pressed together
+	pressAndRelease(BUTTON_SELECT | BUTTON_UP);
+	Events ok = Events(), up = Events();
+	unsigned changes(0);
+	while (millis() < t0 + 500)
+	{
+		changes += oled.debouncer_OK.update();
+		changes += oled.debouncer_Up.update();
+		count(ok, oled.debouncer_OK.rose(), oled.debouncer_OK.fell());
+		count(up, oled.debouncer_Up.rose(), oled.debouncer_Up.fell());
+		TwiEmu::advance(STEP_US);
+	}
+	printf("# pin update: OK press at %lu ms, Up press at %lu ms\n", ok.firstRose, up.firstRose);
+	check(ok.rose == 1 && ok.fell == 1, "pin_update_first_pin");
+	check(up.rose == 1 && up.fell == 1, "pin_update_second_pin");
+	check(changes == 4, "pin_update_returns_change_once");
+
+	// interval() of a pin sets the interval of the port
+	pressAndRelease(BUTTON_SELECT);
+	oled.debouncer_OK.interval(30);
+	Events slow = Events();
+	while (millis() < t0 + 500)
+	{
+		oled.debouncer_OK.update();
+		count(slow, oled.debouncer_OK.rose(), oled.debouncer_OK.fell());
+		TwiEmu::advance(STEP_US);
+	}
+	printf("# interval 30 ms: press at %lu ms, release at %lu ms\n", slow.firstRose, slow.firstFell);
+	check(slow.rose == 1 && slow.fell == 1, "interval_one_press_one_release");
+	check(slow.firstRose >= 100 + 30 && slow.firstRose <= 100 + BOUNCE_TIME + 2 * 30, "interval_press_after_debounce_time");
+
+	// attach() of a pin as at BounceSimplePcf, a button pressed at attach is no change
+	startScript();
+	TwiEmu::scriptButtons(t0 + 1, BUTTON_UP);
+	bounce(100, BUTTON_UP | BUTTON_SELECT, BUTTON_UP);
+	bounce(300, BUTTON_UP, BUTTON_UP | BUTTON_SELECT);
+	TwiEmu::advance(2000);
+	oled.debouncer_Up.attach(PCF8574_ADDR, 3, DEBOUNCE_TIME);
+	Events attached = Events(), held = Events();
+	while (millis() < t0 + 50)
+	{
+		oled.debouncer_Up.update();
+		count(held, oled.debouncer_Up.rose(), oled.debouncer_Up.fell());
+		TwiEmu::advance(STEP_US);
+	}
+	check(oled.debouncer_Up.read() && !held.rose && !held.fell, "attach_initial_state");
+	oled.debouncer_OK.attach(PCF8574_ADDR, 0, DEBOUNCE_TIME);
+	while (millis() < t0 + 500)
+	{
+		oled.debouncer_OK.update();
+		count(attached, oled.debouncer_OK.rose(), oled.debouncer_OK.fell());
+		TwiEmu::advance(STEP_US);
+	}
+	check(attached.rose == 1 && attached.fell == 1, "attach_one_press_one_release");
+
+	printf("%d failure(s)\n", failures);
+	return failures ? 1 : 0;
+}
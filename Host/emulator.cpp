@@ -0,0 +1,77 @@
+/*
+ *  emulator.cpp
+ *
+ *  runs the HelloWorld example at the host with the emulated
+ *  SH1106 display and PCF8574 buttons, reports the bus traffic
+ *  of each step and writes the display content as PBM image
+ *
+ *  build: Host/build.sh Host/emulator.cpp
+ *  usage: Host/build/emulator [image.pbm]
+ */
+#include <Arduino.h>
+#include "OLEDPanel.h"
+#include "twi_emu.h"
+
+#define PCF8574_ADDR 0x21 << 1
+
+OLEDPanel oled = OLEDPanel();
+
+static void report(const char *step)
+{
+	i2c_flush();
+	printf("%-24s %6lu bytes %5lu transactions %9.0f us at 100kHz %8.0f us at 400kHz\n",
+	       step, TwiEmu::stats.bytes, TwiEmu::stats.starts,
+	       TwiEmu::stats.micros(100000UL), TwiEmu::stats.micros(400000UL));
+	TwiEmu::resetStats();
+}
+
+int main(int argc, char *argv[])
+{
+	TwiEmu::reset();
+	// buttons pressed while the loop runs
+	TwiEmu::scriptButtons(2000, BUTTON_UP);
+	TwiEmu::scriptButtons(2300, 0);
+	TwiEmu::scriptButtons(4000, BUTTON_SELECT);
+	TwiEmu::scriptButtons(4300, 0);
+
+	if (oled.detect_i2c(PCF8574_ADDR) != 0)
+		printf("OLED-Panel missing...\n");
+	report("detect_i2c");
+
+	oled.begin();
+	report("begin");
+
+	oled.setCursor(0, 0);
+	oled.print("Hello, world!");
+	report("print \"Hello, world!\"");
+
+	unsigned long loops(0);
+	while (millis() < 6000)
+	{
+		oled.setCursor(0, 1);
+		oled.print(millis() / 1000);
+
+		uint8_t buttons(oled.readButtons());
+		if (buttons)
+		{
+			oled.setCursor(0, 2);
+			if (buttons & BUTTON_UP)
+				oled.print("UP    ");
+			if (buttons & BUTTON_SELECT)
+				oled.print("SELECT");
+		}
+		++loops;
+		TwiEmu::advance(1000);	// rest of the loop
+	}
+	printf("%lu loops in %lu ms\n", loops, millis());
+	report("loop");
+
+	const char *fileName(argc > 1 ? argv[1] : "emulator.pbm");
+	if (!TwiEmu::display.writePBM(fileName))
+	{
+		printf("can't write %s\n", fileName);
+		return 1;
+	}
+	TwiEmu::display.printAscii(stdout);
+	return 0;
+}
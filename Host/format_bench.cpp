@@ -0,0 +1,161 @@
+/*
+ *  format_bench.cpp
+ *
+ *  OLEDPanel::intToAscii (subtraction of powers of ten, shifts) against
+ *  the former routine with division per digit: checks that both give the
+ *  same text and prints the time per call at the host, checks the fixed-width,
+ *  padded and fixed-point formats of formatNumber
+ *
+ *  at the host division is cheap, at AVR the 32 bit division per digit is a
+ *  call of __udivmodsi4 (several hundred cycles), so the table gives an
+ *  estimate of AVR cycles per call from the digits as well (AVR_* below)
+ *
+ *  build: Host/build.sh Host/format_bench.cpp
+ *  usage: Host/build/format_bench      exit code 1 if a text differs
+ */
+#include <Arduino.h>
+#include "OLEDPanel.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BUF_SIZE 33
+#define VALUE_COUNT 4096
+#define ROUNDS 500
+
+// AVR cycles, about
+#define AVR_UDIVMODSI4_CYCLES 650	// __udivmodsi4 per digit
+#define AVR_SUB32_CYCLES 10	// compare and subtract of a 32 bit value
+#define AVR_SUB16_CYCLES 6	// compare and subtract of a 16 bit value
+#define AVR_DIGIT_CYCLES 12	// store, loop, read power from flash
+
+// intToAscii as it was (without the write in front of buf): one division and one modulo per digit
+static char* divisionToAscii(char *buf, uint8_t len, unsigned long n, uint8_t base)
+{
+	char *str(&buf[len-1]);
+	*str = '\0';
+	if (base < BIN)
+		base = DEC;
+	do
+	{
+		char c(n % base);
+		n /= base;
+		*--str = c < 10 ? c + '0' : c + 'A' - 10;
+		--len;
+	} while(n && (len > 1));
+	return str;
+}
+
+static unsigned long values[VALUE_COUNT];
+
+static double avrCycles(unsigned long n, uint8_t base, bool bDivision)
+{
+	char buf[BUF_SIZE];
+	const char *pText(divisionToAscii(buf, BUF_SIZE, n, base));
+	uint8_t iDigits(strlen(pText));
+	if (bDivision)
+		return iDigits * (AVR_UDIVMODSI4_CYCLES + AVR_DIGIT_CYCLES);
+	if (base == HEX || base == OCT || base == BIN)
+	{
+		// 32 bit shift: 4 cycles per bit
+		uint8_t iShift(base == HEX ? 4 : base == OCT ? 3 : 1);
+		return iDigits * (4 * iShift + AVR_DIGIT_CYCLES);
+	}
+	if (base != DEC)
+		return iDigits * (AVR_UDIVMODSI4_CYCLES + AVR_DIGIT_CYCLES);
+	// one subtraction more than the digit, search of first power
+	double cycles((10 - iDigits) * AVR_SUB32_CYCLES);
+	for (uint8_t i = 0; i < iDigits; i++)
+		cycles += (pText[i] - '0' + 1) * ((n >> 16) ? AVR_SUB32_CYCLES : AVR_SUB16_CYCLES) + AVR_DIGIT_CYCLES;
+	return cycles;
+}
+
+static void makeValues(unsigned long ulMax)
+{
+	uint32_t x(12345);
+	for (int i = 0; i < VALUE_COUNT; i++)
+	{
+		// xorshift, spread over all digit counts up to ulMax
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		values[i] = (x >> (x % 32)) % (ulMax + 1);
+	}
+	values[0] = 0;
+	values[1] = ulMax;
+}
+
+static double nanosPerCall(char* (*format)(char*, uint8_t, unsigned long, uint8_t), uint8_t base)
+{
+	char buf[BUF_SIZE];
+	volatile char sink(0);
+	clock_t start(clock());
+	for (int r = 0; r < ROUNDS; r++)
+		for (int i = 0; i < VALUE_COUNT; i++)
+			sink += *format(buf, BUF_SIZE, values[i], base);
+	(void)sink;
+	return (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / ((double)ROUNDS * VALUE_COUNT);
+}
+
+static int checkFormat(unsigned long n, int iType, bool bNegative, const char *pExpected)
+{
+	char buf[BUF_SIZE];
+	const char *pText(OLEDPanel::formatNumber(buf, BUF_SIZE, n, iType, bNegative));
+	if (!strcmp(pText, pExpected))
+		return 0;
+	printf("DIFF\tformatNumber(%lu, 0x%04x, %d)\t\"%s\" expected \"%s\"\n", n, iType, bNegative, pText, pExpected);
+	return 1;
+}
+
+int main()
+{
+	static const uint8_t bases[] = { DEC, HEX, OCT, BIN, 3 };
+	static const unsigned long ranges[] = { 255UL, 65535UL, 0xFFFFFFFFUL };
+	int differences(0);
+
+	printf("# base\trange\tdivision ns\tintToAscii ns\tAVR division cycles\tAVR intToAscii cycles\n");
+	for (uint8_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); r++)
+	{
+		makeValues(ranges[r]);
+		for (uint8_t b = 0; b < sizeof(bases); b++)
+		{
+			double oldCycles(0), newCycles(0);
+			for (int i = 0; i < VALUE_COUNT; i++)
+			{
+				oldCycles += avrCycles(values[i], bases[b], true);
+				newCycles += avrCycles(values[i], bases[b], false);
+				char bufOld[BUF_SIZE], bufNew[BUF_SIZE];
+				const char *pOld(divisionToAscii(bufOld, BUF_SIZE, values[i], bases[b]));
+				const char *pNew(OLEDPanel::intToAscii(bufNew, BUF_SIZE, values[i], bases[b]));
+				if (strcmp(pOld, pNew))
+				{
+					printf("DIFF\t%lu base %u\t\"%s\" -> \"%s\"\n", values[i], bases[b], pOld, pNew);
+					differences++;
+				}
+			}
+			printf("%u\t%lu\t%.1f\t%.1f\t%.0f\t%.0f\n", bases[b], ranges[r],
+			       nanosPerCall(divisionToAscii, bases[b]), nanosPerCall(OLEDPanel::intToAscii, bases[b]),
+			       oldCycles / VALUE_COUNT, newCycles / VALUE_COUNT);
+		}
+	}
+
+	differences += checkFormat(42, DEC | FMT_WIDTH(5), false, "   42");
+	differences += checkFormat(42, DEC | FMT_WIDTH(5) | FMT_ZERO, false, "00042");
+	differences += checkFormat(42, DEC | FMT_WIDTH(5) | FMT_ZERO, true, "-0042");
+	differences += checkFormat(42, DEC | FMT_WIDTH(5), true, "  -42");
+	differences += checkFormat(235, DEC | FMT_DECIMALS(1), false, "23.5");
+	differences += checkFormat(5, DEC | FMT_DECIMALS(2), true, "-0.05");
+	differences += checkFormat(5, DEC | FMT_DECIMALS(2) | FMT_WIDTH(6), false, "  0.05");
+	differences += checkFormat(123456, DEC | FMT_DECIMALS(3) | FMT_WIDTH(4), false, "123.456");
+	differences += checkFormat(0xAB, HEX | FMT_WIDTH(4) | FMT_ZERO, false, "00AB");
+	differences += checkFormat(5, BIN | FMT_WIDTH(8) | FMT_ZERO, false, "00000101");
+	differences += checkFormat(0xFFFFFFFFUL, DEC, false, "4294967295");
+
+	// buffer smaller than the number: lower digits as before
+	char small[4];
+	differences += strcmp(OLEDPanel::intToAscii(small, sizeof(small), 12345UL, DEC), "345") != 0;
+
+	printf("%d difference(s)\n", differences);
+	return differences ? 1 : 0;
+}
@@ -0,0 +1,269 @@
+/*
+ *  graphic_bench.cpp
+ *
+ *  graphic functions of lcd.c against the former implementation
+ *  (one lcd_drawPixel per pixel): checks that both draw the same pixels
+ *  into the buffer and prints the time per call at the host,
+ *  filled shapes are checked against their outline filled column by column,
+ *  reports the wire time per call of lcd_displayStep() for a full frame
+ *
+ *  build: GRAPHIC=1 Host/build.sh Host/graphic_bench.cpp
+ *  usage: Host/build/graphic_bench      exit code 1 if an image differs
+ */
+#include <Arduino.h>
+#include "OLEDPanel.h"
+#include "twi_emu.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if !defined GRAPHICMODE
+#error "build with GRAPHIC=1"
+#endif
+
+#define ROUNDS 2000
+
+//=== former implementation ===================================================
+static void formerLine(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t color)
+{
+	if (x1 > DISPLAY_WIDTH - 1 || x2 > DISPLAY_WIDTH - 1 || y1 > DISPLAY_HEIGHT - 1 || y2 > DISPLAY_HEIGHT - 1)
+		return;
+	int dx = abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
+	int dy = -abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
+	int err = dx + dy, e2;
+	while (1)
+	{
+		lcd_drawPixel(x1, y1, color);
+		if (x1 == x2 && y1 == y2)
+			break;
+		e2 = 2 * err;
+		if (e2 > dy) { err += dy; x1 += sx; }
+		if (e2 < dx) { err += dx; y1 += sy; }
+	}
+}
+
+static void formerRect(uint8_t px1, uint8_t py1, uint8_t px2, uint8_t py2, uint8_t color)
+{
+	formerLine(px1, py1, px2, py1, color);
+	formerLine(px2, py1, px2, py2, color);
+	formerLine(px2, py2, px1, py2, color);
+	formerLine(px1, py2, px1, py1, color);
+}
+
+static void formerFillRect(uint8_t px1, uint8_t py1, uint8_t px2, uint8_t py2, uint8_t color)
+{
+	for (uint8_t i = 0; i <= (py2 - py1); i++)
+		formerLine(px1, py1 + i, px2, py1 + i, color);
+}
+
+static void formerFillCircle(uint8_t center_x, uint8_t center_y, uint8_t radius, uint8_t color)
+{
+	// concentric outlines, whole circle rejected at the edges
+	if (center_x + radius > DISPLAY_WIDTH - 1 || center_y + radius > DISPLAY_HEIGHT - 1 ||
+	    center_x < radius || center_y < radius)
+		return;
+	for (uint8_t i = 0; i <= radius; i++)
+		lcd_drawCircle(center_x, center_y, i, color);
+}
+
+//=== workloads ===============================================================
+struct Workload {
+	const char *name;
+	void (*former)();
+	void (*current)();
+	bool filled;	// current is the image of former filled column by column
+};
+
+static void formerFullFill() { formerFillRect(0, 0, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1, WHITE); }
+static void currentFullFill() { lcd_fillRect(0, 0, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1, WHITE); }
+static void formerSmallFill() { formerFillRect(5, 3, 40, 13, WHITE); formerFillRect(10, 6, 20, 9, BLACK); }
+static void currentSmallFill() { lcd_fillRect(5, 3, 40, 13, WHITE); lcd_fillRect(10, 6, 20, 9, BLACK); }
+static void formerRects()
+{
+	for (uint8_t i = 0; i < 30; i += 3)
+		formerRect(i, i / 2, DISPLAY_WIDTH - 1 - i, DISPLAY_HEIGHT - 1 - i / 2, WHITE);
+}
+static void currentRects()
+{
+	for (uint8_t i = 0; i < 30; i += 3)
+		lcd_drawRect(i, i / 2, DISPLAY_WIDTH - 1 - i, DISPLAY_HEIGHT - 1 - i / 2, WHITE);
+}
+static void formerGrid()
+{
+	for (uint8_t x = 0; x < DISPLAY_WIDTH; x += 8)
+		formerLine(x, 0, x, DISPLAY_HEIGHT - 1, WHITE);
+	for (uint8_t y = 0; y < DISPLAY_HEIGHT; y += 8)
+		formerLine(0, y, DISPLAY_WIDTH - 1, y, WHITE);
+}
+static void currentGrid()
+{
+	for (uint8_t x = 0; x < DISPLAY_WIDTH; x += 8)
+		lcd_drawLine(x, 0, x, DISPLAY_HEIGHT - 1, WHITE);
+	for (uint8_t y = 0; y < DISPLAY_HEIGHT; y += 8)
+		lcd_drawLine(0, y, DISPLAY_WIDTH - 1, y, WHITE);
+}
+
+static void formerBigCircle() { formerFillCircle(64, 32, 30, WHITE); }
+static void currentBigCircle() { lcd_fillCircle(64, 32, 30, WHITE); }
+static void formerSmallCircles()
+{
+	for (uint8_t x = 8; x < DISPLAY_WIDTH; x += 16)
+		formerFillCircle(x, 20, 6, WHITE);
+}
+static void currentSmallCircles()
+{
+	for (uint8_t x = 8; x < DISPLAY_WIDTH; x += 16)
+		lcd_fillCircle(x, 20, 6, WHITE);
+}
+// rounded rectangle with the former functions
+static void formerRoundRect()
+{
+	formerFillRect(22, 5, 105, 58, WHITE);
+	formerFillRect(10, 17, 117, 46, WHITE);
+	formerFillCircle(22, 17, 12, WHITE);
+	formerFillCircle(105, 17, 12, WHITE);
+	formerFillCircle(105, 46, 12, WHITE);
+	formerFillCircle(22, 46, 12, WHITE);
+}
+static void currentRoundRect() { lcd_fillRoundRect(10, 5, 117, 58, 12, WHITE); }
+
+// icon as row-major bitmap (lcd_drawBitmap) and in page format (lcd_drawPageBitmap)
+#define ICON_WIDTH 32
+#define ICON_HEIGHT 24
+static uint8_t iconRows[ICON_HEIGHT][ICON_WIDTH / 8];
+static uint8_t iconPages[(ICON_HEIGHT + 7) / 8][ICON_WIDTH];
+
+static void makeIcon()
+{
+	for (uint8_t y = 0; y < ICON_HEIGHT; y++)
+		for (uint8_t x = 0; x < ICON_WIDTH; x++)
+			if ((x * x + y * y) % 7 < 3 || x == y)
+			{
+				iconRows[y][x / 8] |= 0x80 >> (x % 8);
+				iconPages[y / 8][x] |= 1 << (y % 8);
+			}
+}
+static void formerAlignedBitmap() { lcd_drawBitmap(10, 16, iconRows[0], ICON_WIDTH, ICON_HEIGHT, WHITE); }
+static void currentAlignedBitmap() { lcd_drawPageBitmap(10, 16, iconPages[0], ICON_WIDTH, ICON_HEIGHT, BITMAP_OPAQUE); }
+static void formerShiftedBitmap() { lcd_drawBitmap(10, 19, iconRows[0], ICON_WIDTH, ICON_HEIGHT, WHITE); }
+static void currentShiftedBitmap() { lcd_drawPageBitmap(10, 19, iconPages[0], ICON_WIDTH, ICON_HEIGHT, BITMAP_OPAQUE); }
+
+static const Workload workloads[] = {
+	{ "fillRect_full", formerFullFill, currentFullFill, false },
+	{ "fillRect_small", formerSmallFill, currentSmallFill, false },
+	{ "drawRect", formerRects, currentRects, false },
+	{ "hv_lines", formerGrid, currentGrid, false },
+	{ "fillCircle_big", formerBigCircle, currentBigCircle, true },
+	{ "fillCircle_small", formerSmallCircles, currentSmallCircles, true },
+	{ "fillRoundRect", formerRoundRect, currentRoundRect, true },
+	{ "bitmap_aligned", formerAlignedBitmap, currentAlignedBitmap, false },
+	{ "bitmap_shifted", formerShiftedBitmap, currentShiftedBitmap, false },
+};
+
+//=== measurement =============================================================
+static uint8_t image[DISPLAY_HEIGHT][DISPLAY_WIDTH];
+
+static void keepImage()
+{
+	for (uint8_t y = 0; y < DISPLAY_HEIGHT; y++)
+		for (uint8_t x = 0; x < DISPLAY_WIDTH; x++)
+			image[y][x] = lcd_check_buffer(x, y) ? 1 : 0;
+}
+
+static void fillColumns()
+{
+	for (uint8_t x = 0; x < DISPLAY_WIDTH; x++)
+	{
+		int8_t first(-1), last(-1);
+		for (uint8_t y = 0; y < DISPLAY_HEIGHT; y++)
+			if (image[y][x])
+			{
+				if (first < 0)
+					first = y;
+				last = y;
+			}
+		for (int8_t y = first; first >= 0 && y <= last; y++)
+			image[y][x] = 1;
+	}
+}
+
+static bool sameImage()
+{
+	for (uint8_t y = 0; y < DISPLAY_HEIGHT; y++)
+		for (uint8_t x = 0; x < DISPLAY_WIDTH; x++)
+			if (image[y][x] != (lcd_check_buffer(x, y) ? 1 : 0))
+				return false;
+	return true;
+}
+
+static double microsPerCall(void (*draw)())
+{
+	clock_t start(clock());
+	for (int r = 0; r < ROUNDS; r++)
+	{
+		lcd_clear_buffer();
+		draw();
+	}
+	return (double)(clock() - start) / CLOCKS_PER_SEC * 1e6 / ROUNDS;
+}
+
+// longest wire time of one call at 100 kHz while a full frame is send
+static void frameSteps(uint16_t budget)
+{
+	lcd_fillRect(0, 0, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1, WHITE);
+	i2c_flush();
+	uint16_t calls(0);
+	double longest(0), total(0);
+	uint8_t done(0);
+	while (!done)
+	{
+		TwiEmu::resetStats();
+		done = lcd_displayStep(budget);
+		i2c_flush();
+		calls++;
+		double us(TwiEmu::stats.micros(100000UL));
+		total += us;
+		if (us > longest)
+			longest = us;
+	}
+	printf("%u\t%u\t%.0f\t%.0f\n", budget, calls, longest, total);
+	lcd_clear_buffer();
+	lcd_display();
+}
+
+int main()
+{
+	TwiEmu::reset();
+	lcd_init(LCD_DISP_ON);
+	makeIcon();
+	int differences(0);
+	printf("# workload\tformer us\tcurrent us\tspeedup\n");
+	for (uint8_t i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++)
+	{
+		const Workload &w(workloads[i]);
+		lcd_clear_buffer();
+		w.former();
+		keepImage();
+		if (w.filled)
+			fillColumns();
+		lcd_clear_buffer();
+		w.current();
+		if (!sameImage())
+		{
+			printf("DIFF\t%s\n", w.name);
+			differences++;
+		}
+		double former(microsPerCall(w.former));
+		double current(microsPerCall(w.current));
+		printf("%s\t%.2f\t%.2f\t%.1f\n", w.name, former, current, current > 0 ? former / current : 0.0);
+	}
+	printf("# lcd_displayStep budget\tcalls\tlongest us@100kHz\tframe us@100kHz\n");
+	frameSteps(0xffff);
+	frameSteps(128);
+	frameSteps(100);
+	frameSteps(50);
+	printf("%d difference(s)\n", differences);
+	return differences ? 1 : 0;
+}
@@ -0,0 +1,248 @@
+/*
+ *  packed_bench.cpp
+ *
+ *  run-length coded bitmaps (lcd_putPackedBitmap) against raw bitmaps in
+ *  page format: flash size, runs to decode and the time of decoding
+ *  compared with the wire time of the picture, checks the picture shown
+ *
+ *  TEXTMODE:    decoded while queued for the bus, bus bytes of both
+ *  GRAPHICMODE: decoded into the buffer, time at the host against memcpy
+ *
+ *  build: Host/build.sh Host/packed_bench.cpp
+ *         GRAPHIC=1 Host/build.sh Host/packed_bench.cpp
+ *  usage: Host/build/packed_bench      exit code 1 if a picture differs
+ */
+#include <Arduino.h>
+#include "OLEDPanel.h"
+#include "twi_emu.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ROUNDS 20000
+#define PAGES (DISPLAY_HEIGHT / 8)
+#define GLYPH_WIDTH 6	// columns of a char of the font
+
+//=== pictures ================================================================
+static uint8_t picture[PAGES][DISPLAY_WIDTH];
+static uint8_t packed[2 + PAGES * (DISPLAY_WIDTH + 2)];
+static uint16_t packedSize;
+static uint16_t runs;
+
+static void setPixel(uint8_t x, uint8_t y)
+{
+	picture[y / 8][x] |= 1 << (y % 8);
+}
+
+static void text(uint8_t x, uint8_t page, const char *s)
+{
+	for (; *s && x + GLYPH_WIDTH <= DISPLAY_WIDTH; s++)
+		for (uint8_t i = 0; i < GLYPH_WIDTH; i++)
+			picture[page][x++] = lcd_glyphColumn(lcd_charIndex(*s), i, NORMALSIZE);
+}
+
+static void splash()
+{
+	for (uint8_t x = 0; x < DISPLAY_WIDTH; x++)
+	{
+		setPixel(x, 0);
+		setPixel(x, DISPLAY_HEIGHT - 1);
+	}
+	for (uint8_t y = 0; y < DISPLAY_HEIGHT; y++)
+	{
+		setPixel(0, y);
+		setPixel(DISPLAY_WIDTH - 1, y);
+	}
+	for (int8_t y = -12; y <= 12; y++)
+		for (int8_t x = -12; x <= 12; x++)
+			if (x * x + y * y <= 144)
+				setPixel(30 + x, 24 + y);
+	text(50, 2, "OLEDPanel");
+	text(50, 3, "v1.0");
+	text(20, 6, "starting...");
+}
+
+static void textScreen()
+{
+	static const char *lines[PAGES] = {
+		"Status     12:34:56", "Speed:      1234 rpm", "Temp:       21.5 C", "Voltage:    12.04 V",
+		"Current:    0.35 A", "Mode:       auto", "Errors:     none", "> Menu  < Back",
+	};
+	for (uint8_t page = 0; page < PAGES; page++)
+		text(0, page, lines[page]);
+}
+
+static void icons()
+{
+	// 8 icons of 16x16 at the top, like an icon bar
+	for (uint8_t icon = 0; icon < 8; icon++)
+		for (uint8_t y = 0; y < 16; y++)
+			for (uint8_t x = 0; x < 16; x++)
+				if ((x * x + y * y + icon * 5) % 7 < 2 || x == y || x == 15 - y)
+					setPixel(icon * 16 + x, y);
+}
+
+static void noise()
+{
+	srand(1);
+	for (uint8_t page = 0; page < PAGES; page++)
+		for (uint8_t x = 0; x < DISPLAY_WIDTH; x++)
+			picture[page][x] = rand();
+}
+
+// same coding as Host/bitmap2c.py -p
+static void pack()
+{
+	packedSize = 0;
+	runs = 0;
+	packed[packedSize++] = DISPLAY_WIDTH;
+	packed[packedSize++] = PAGES;
+	for (uint8_t page = 0; page < PAGES; page++)
+	{
+		const uint8_t *data(picture[page]);
+		uint8_t literal(0), i(0);
+		while (i < DISPLAY_WIDTH || literal)
+		{
+			uint8_t count(1);
+			while (i + count < DISPLAY_WIDTH && count < 130 && data[i + count] == data[i])
+				count++;
+			if (i == DISPLAY_WIDTH || count >= 3 || literal == 128)
+			{
+				if (literal)
+				{
+					packed[packedSize++] = literal - 1;
+					memcpy(&packed[packedSize], &data[i - literal], literal);
+					packedSize += literal;
+					literal = 0;
+					runs++;
+				}
+				if (i < DISPLAY_WIDTH && count >= 3)
+				{
+					packed[packedSize++] = 0x80 | (count - 3);
+					packed[packedSize++] = data[i];
+					i += count;
+					runs++;
+				}
+			}
+			else
+			{
+				literal++;
+				i++;
+			}
+		}
+	}
+}
+
+struct Picture {
+	const char *name;
+	void (*draw)();
+};
+
+static const Picture pictures[] = {
+	{ "splash", splash },
+	{ "text", textScreen },
+	{ "icons", icons },
+	{ "noise", noise },
+};
+
+//=== measurement =============================================================
+static bool shown()
+{
+	for (uint8_t y = 0; y < DISPLAY_HEIGHT; y++)
+		for (uint8_t x = 0; x < DISPLAY_WIDTH; x++)
+#if defined GRAPHICMODE
+			if (((picture[y / 8][x] >> (y % 8)) & 1) != (lcd_check_buffer(x, y) ? 1 : 0))
+#else
+			if (((picture[y / 8][x] >> (y % 8)) & 1) != (TwiEmu::display.pixel(x, y) ? 1 : 0))
+#endif
+				return false;
+	return true;
+}
+
+static double microsPerCall(bool fromPacked)
+{
+	clock_t start(clock());
+	for (int r = 0; r < ROUNDS; r++)
+	{
+		if (fromPacked)
+			lcd_putPackedBitmap(0, 0, packed);
+		else
+#if defined GRAPHICMODE
+			lcd_drawPageBitmap(0, 0, picture[0], DISPLAY_WIDTH, DISPLAY_HEIGHT, BITMAP_OPAQUE);
+#else
+			lcd_putBitmap(0, 0, picture[0], DISPLAY_WIDTH, PAGES);
+#endif
+#if defined TEXTMODE
+		i2c_flush();
+#endif
+	}
+	return (double)(clock() - start) / CLOCKS_PER_SEC * 1e6 / ROUNDS;
+}
+
+// bus traffic of the picture at 400 kHz, raw bitmap or packed
+static TwiStats transfer(bool fromPacked)
+{
+	i2c_flush();
+	TwiEmu::resetStats();
+#if defined GRAPHICMODE
+	(void)fromPacked;
+	lcd_clear_buffer();
+	lcd_display();
+	i2c_flush();
+	TwiEmu::resetStats();
+	lcd_drawPageBitmap(0, 0, picture[0], DISPLAY_WIDTH, DISPLAY_HEIGHT, BITMAP_OPAQUE);
+	lcd_display();
+#else
+	if (fromPacked)
+		lcd_putPackedBitmap(0, 0, packed);
+	else
+		lcd_putBitmap(0, 0, picture[0], DISPLAY_WIDTH, PAGES);
+#endif
+	i2c_flush();
+	return TwiEmu::stats;
+}
+
+int main()
+{
+	TwiEmu::reset();
+	OLEDPanel oled;
+	oled.begin();
+	i2c_setClock(400000UL);
+	int differences(0);
+#if defined GRAPHICMODE
+	printf("# picture\traw\tpacked\truns\tcopy us\tdecode us\twire us\n");
+#else
+	printf("# picture\traw\tpacked\truns\tbus raw\tbus packed\tsend us\tsend packed us\twire us\n");
+#endif
+	for (uint8_t i = 0; i < sizeof(pictures) / sizeof(pictures[0]); i++)
+	{
+		const Picture &p(pictures[i]);
+		memset(picture, 0, sizeof(picture));
+		p.draw();
+		pack();
+
+		TwiStats raw(transfer(false));
+#if defined GRAPHICMODE
+		lcd_clear_buffer();
+		lcd_putPackedBitmap(0, 0, packed);
+		bool same(shown());
+		printf("%s\t%u\t%u\t%u\t%.2f\t%.2f\t%.0f\n", p.name, (unsigned)sizeof(picture), packedSize, runs,
+		       microsPerCall(false), microsPerCall(true), raw.micros(400000UL));
+#else
+		lcd_clrscr();
+		TwiStats fromPacked(transfer(true));
+		bool same(shown());
+		printf("%s\t%u\t%u\t%u\t%lu\t%lu\t%.2f\t%.2f\t%.0f\n", p.name, (unsigned)sizeof(picture), packedSize, runs,
+		       raw.bytes, fromPacked.bytes, microsPerCall(false), microsPerCall(true), fromPacked.micros(400000UL));
+#endif
+		if (!same)
+		{
+			printf("DIFF\t%s\n", p.name);
+			differences++;
+		}
+	}
+	printf("%d difference(s)\n", differences);
+	return differences ? 1 : 0;
+}
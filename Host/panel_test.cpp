@@ -0,0 +1,230 @@
+/*
+ *  panel_test.cpp
+ *
+ *  bus handling of OLEDPanel at the emulated TWI: setBusClock() with probe
+ *  falls back to the highest standard clock all devices acknowledge, a
+ *  device is set offline after I2C_OFFLINE_FAILS failed transmissions in a
+ *  row (a single failure keeps it and the display content), transmissions
+ *  to it are skipped and it is initialized again when it is reconnected,
+ *  an OLEDField is send again after clear() and reconnect, at GRAPHICMODE
+ *  the buffer is kept and send again after reconnect
+ *
+ *  build: Host/build.sh Host/panel_test.cpp   or
+ *         GRAPHIC=1 Host/build.sh Host/panel_test.cpp
+ *  usage: Host/build/panel_test      exit code 1 if a check fails
+ */
+#include <Arduino.h>
+#include "OLEDPanel.h"
+#include "twi_emu.h"
+
+#include <stdio.h>
+
+#define PCF8574_ADDR (0x21 << 1)
+
+static OLEDPanel oled;
+static OLEDField field(10, 5, 4);
+static int failures;
+
+static void check(bool ok, const char *name)
+{
+	printf("%s\t%s\n", ok ? "ok" : "FAIL", name);
+	if (!ok)
+		failures++;
+}
+
+static void start(unsigned long displayMaxClock, unsigned long keypadMaxClock)
+{
+	TwiEmu::reset();
+	TwiEmu::displayAddress = LCD_I2C_ADR;
+	TwiEmu::keypadAddress = PCF8574_ADDR >> 1;
+	i2c_setOnline(LCD_I2C_ADR << 1);
+	i2c_setOnline(PCF8574_ADDR);
+	TwiEmu::displayMaxClock = displayMaxClock;
+	TwiEmu::keypadMaxClock = keypadMaxClock;
+	oled.setBusClock(100000UL);
+	oled.detect_i2c(PCF8574_ADDR);
+	oled.begin();
+}
+
+// GRAPHICMODE: buffer is send to display, text continues at the cursor
+static void show()
+{
+#if defined GRAPHICMODE
+	uint8_t x, y;
+	lcd_get_xpix_y(&x, &y);
+	lcd_display();
+	lcd_goto_xpix_y(x, y);
+#endif
+}
+
+// display and PCF8574 are online and a text is send at the clock set
+static bool busWorks()
+{
+	if (!i2c_online(LCD_I2C_ADR << 1) || !i2c_online(PCF8574_ADDR))
+		return false;
+	TwiEmu::resetStats();
+	oled.setCursor(0, 0);
+	oled.print(F("bus"));
+	show();
+	oled.readButtons();
+	return TwiEmu::stats.nacks == 0 && TwiEmu::display.dataBytes > 0 && TwiEmu::keypad.reads > 0;
+}
+
+// any pixel of the character at x, y is set
+static bool charShown(uint8_t x, uint8_t y)
+{
+	for (uint8_t px = 0; px < CHAR_WIDTH; px++)
+		for (uint8_t py = 0; py < CHAR_HEIGHT; py++)
+			if (TwiEmu::display.pixel(x * CHAR_WIDTH + px, y * CHAR_HEIGHT + py))
+				return true;
+	return false;
+}
+
+static void printAt(uint8_t x, uint8_t y, const char *pText)
+{
+	oled.setCursor(x, y);
+	oled.print(pText);
+	show();
+}
+
+int main()
+{
+	// setBusClock(clock, true): highest standard clock acknowledged by all devices
+	start(0, 0);
+	uint32_t ulClock(oled.setBusClock(1000000UL, true));
+	printf("# probe, any clock: %lu Hz\n", (unsigned long)ulClock);
+	check(ulClock == 1000000UL && TwiEmu::busClock() == ulClock, "probe_any_clock");
+	check(busWorks(), "probe_any_clock_bus_works");
+
+	start(400000UL, 0);
+	ulClock = oled.setBusClock(1000000UL, true);
+	printf("# probe, display up to 400 kHz: %lu Hz\n", (unsigned long)ulClock);
+	check(ulClock == 400000UL && TwiEmu::busClock() == ulClock, "probe_display_fallback_400kHz");
+	check(busWorks(), "probe_display_fallback_bus_works");
+
+	start(0, 100000UL);
+	ulClock = oled.setBusClock(1000000UL, true);
+	printf("# probe, PCF8574 up to 100 kHz: %lu Hz\n", (unsigned long)ulClock);
+	check(ulClock == 100000UL && TwiEmu::busClock() == ulClock, "probe_keypad_fallback_100kHz");
+	check(busWorks(), "probe_keypad_fallback_bus_works");
+
+	start(700000UL, 0);
+	ulClock = oled.setBusClock(700000UL, true);
+	printf("# probe, 700 kHz requested and acknowledged: %lu Hz\n", (unsigned long)ulClock);
+	// next possible clock not above 700 kHz, no fallback to 400 kHz
+	check(ulClock > 400000UL && ulClock <= 700000UL, "probe_keeps_clock_acknowledged");
+
+	// without probe the clock is set as requested
+	start(400000UL, 0);
+	ulClock = oled.setBusClock(1000000UL);
+	check(ulClock == 1000000UL, "no_probe_no_fallback");
+
+	// PCF8574 missing: offline after I2C_OFFLINE_FAILS reads, display is not affected
+	start(0, 0);
+	TwiEmu::keypadAddress = 0;
+	uint8_t i;
+	for (i = 0; i < 10 && i2c_online(PCF8574_ADDR); i++)
+		oled.readButtons();
+	printf("# PCF8574 missing: offline after %u reads\n", i);
+	check(i == I2C_OFFLINE_FAILS, "keypad_offline_after_fails");
+	TwiEmu::resetStats();
+	oled.readButtons();
+	check(TwiEmu::stats.bytes == 0, "keypad_offline_skipped");
+	printAt(0, 1, "ab");
+	TwiEmu::resetStats();
+	oled.print("cd");
+	show();
+	// text continues at the RAM pointer of the display without adressing
+	check(charShown(3, 1) && TwiEmu::display.commands == 0, "keypad_offline_display_unaffected");
+
+	// display fails once: stays online, content is kept
+	start(0, 0);
+	printAt(0, 0, "X");
+	TwiEmu::displayAddress = 0;
+	printAt(0, 2, "lost");
+	TwiEmu::displayAddress = LCD_I2C_ADR;
+	check(i2c_online(LCD_I2C_ADR << 1) && i2c_failed(LCD_I2C_ADR << 1) == 1, "glitch_display_online");
+	printAt(0, 3, "Y");
+	check(i2c_failed(LCD_I2C_ADR << 1) == 0, "glitch_fails_reset_by_ack");
+	TwiEmu::advance(BUS_REPROBE_TIME * 2000UL);
+	oled.isOnline();
+	check(charShown(0, 0) && charShown(0, 3) && !charShown(0, 2), "glitch_content_kept");
+
+	// failed transmission without adressing: RAM pointer of the display is lost,
+	// the next text and cursor moves are adressed again
+	start(0, 0);
+	printAt(0, 0, "ab");
+	TwiEmu::displayAddress = 0;
+	oled.print("cd");
+	show();
+	TwiEmu::displayAddress = LCD_I2C_ADR;
+	oled.print("e");
+	show();
+	printAt(5, 0, "X");
+	// "cd" is lost, "e" at column 4, "X" at column 5
+	check(!charShown(2, 0) && !charShown(3, 0) && charShown(4, 0) && charShown(5, 0), "failed_run_pointer_lost");
+
+	// field is send again after clear()
+	start(0, 0);
+	field.update(42);
+	show();
+	oled.clear();
+	show();
+	field.update(42);
+	show();
+	check(charShown(12, 5) && charShown(13, 5), "field_after_clear");
+
+	// display removed: offline after I2C_OFFLINE_FAILS, then nothing is send
+	start(0, 0);
+	printAt(0, 0, "X");
+	field.update(42);
+	show();
+	TwiEmu::displayAddress = 0;
+	for (i = 0; i < 10 && i2c_online(LCD_I2C_ADR << 1); i++)
+		printAt(0, 1, "removed");
+	printf("# display removed: offline after %u transmissions\n", i);
+	check(i == I2C_OFFLINE_FAILS, "display_offline_after_fails");
+	// the display is probed once per BUS_REPROBE_TIME
+	oled.isOnline();
+	TwiEmu::resetStats();
+	printAt(0, 2, "skipped");
+	oled.clear();
+	show();
+	check(TwiEmu::stats.bytes == 0, "display_offline_skipped");
+	TwiEmu::resetStats();
+	oled.readButtons();
+	check(TwiEmu::keypad.reads == 1, "display_offline_keypad_works");
+
+	// reconnected: probed after BUS_REPROBE_TIME and initialized
+	TwiEmu::display.reset();
+	TwiEmu::displayAddress = LCD_I2C_ADR;
+	check(!oled.isOnline(), "reconnect_not_before_reprobe_time");
+	TwiEmu::advance(BUS_REPROBE_TIME * 1000UL);
+	check(oled.isOnline() && TwiEmu::display.displayOn, "reconnect_initialized");
+	printAt(0, 4, "back");
+	check(charShown(0, 4) && i2c_failed(LCD_I2C_ADR << 1) == 0, "reconnect_display_works");
+	field.update(42);
+	show();
+	check(charShown(12, 5) && charShown(13, 5), "reconnect_field_send_again");
+
+#if defined GRAPHICMODE
+	// GRAPHICMODE: buffer is kept at reconnect, lcd_display() sends all of it
+	start(0, 0);
+	printAt(0, 0, "X");
+	lcd_fillRect(64, 32, 71, 39, WHITE);
+	show();
+	TwiEmu::displayAddress = 0;
+	for (i = 0; i < 10 && i2c_online(LCD_I2C_ADR << 1); i++)
+		printAt(0, 1, "gone");
+	TwiEmu::display.reset();
+	TwiEmu::displayAddress = LCD_I2C_ADR;
+	TwiEmu::advance(BUS_REPROBE_TIME * 1000UL);
+	check(oled.isOnline() && !charShown(0, 0), "graphic_reconnect_initialized");
+	show();
+	check(charShown(0, 0) && charShown(0, 1) && TwiEmu::display.pixel(64, 32) && TwiEmu::display.pixel(71, 39),
+	      "graphic_reconnect_buffer_send_again");
+#endif
+
+	printf("%d failure(s)\n", failures);
+	return failures ? 1 : 0;
+}
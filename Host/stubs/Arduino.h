@@ -0,0 +1,17 @@
+/*
+ *  Arduino.h (host)
+ *
+ *  millis() and micros() run with the simulated time of the TWI emulation
+ */
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include "Print.h"
+
+unsigned long millis(void);
+unsigned long micros(void);
+
+#endif
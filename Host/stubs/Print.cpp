@@ -0,0 +1,12 @@
+/*
+ *  Print.cpp (host)
+ */
+#include "Print.h"
+#include <stdio.h>
+
+size_t Print::print(double n, int digits)
+{
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%.*f", digits, n);
+	return write(buf);
+}
@@ -0,0 +1,75 @@
+/*
+ *  Print.h (host)
+ *
+ *  the part of the Arduino class Print used by OLEDPanel
+ */
+#ifndef HOST_PRINT_H
+#define HOST_PRINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print {
+public:
+	virtual ~Print() {}
+	virtual size_t write(uint8_t) = 0;
+	virtual size_t write(const uint8_t *buffer, size_t size)
+	{
+		size_t n(0);
+		while (size--)
+		{
+			if (!write(*buffer++))
+				break;
+			n++;
+		}
+		return n;
+	}
+	size_t write(const char *str) { return str ? write((const uint8_t *)str, strlen(str)) : 0; }
+	virtual void flush() {}
+
+	size_t print(const __FlashStringHelper *s) { return write((const char *)s); }
+	size_t print(const String &s) { return write((const uint8_t *)s.c_str(), s.length()); }
+	size_t print(const char s[]) { return write(s); }
+	size_t print(char c) { return write((uint8_t)c); }
+	size_t print(unsigned char b, int base = DEC) { return print((unsigned long)b, base); }
+	size_t print(int n, int base = DEC) { return print((long)n, base); }
+	size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+	size_t print(long n, int base = DEC)
+	{
+		if (base == DEC && n < 0)
+			return print('-') + printNumber(-n, DEC);
+		return printNumber(n, base);
+	}
+	size_t print(unsigned long n, int base = DEC) { return printNumber(n, base); }
+	size_t print(double n, int digits = 2);
+
+	size_t println(void) { return write("\r\n"); }
+	size_t println(const char c[]) { size_t n(print(c)); return n + println(); }
+	size_t println(int v, int base = DEC) { size_t n(print(v, base)); return n + println(); }
+
+private:
+	size_t printNumber(unsigned long n, uint8_t base)
+	{
+		char buf[33];
+		char *s(&buf[32]);
+		*s = '\0';
+		if (base < BIN)
+			base = DEC;
+		do
+		{
+			char c(n % base);
+			n /= base;
+			*--s = c < 10 ? c + '0' : c + 'A' - 10;
+		} while (n);
+		return write(s);
+	}
+};
+
+#endif
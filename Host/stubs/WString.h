@@ -0,0 +1,20 @@
+/*
+ *  WString.h (host)
+ *
+ *  F() strings are ordinary strings at the host
+ */
+#ifndef HOST_WSTRING_H
+#define HOST_WSTRING_H
+
+#include <string>
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+
+class String : public std::string {
+public:
+	String(const char *s = "") : std::string(s) {}
+	unsigned int length() const { return (unsigned int)size(); }
+};
+
+#endif
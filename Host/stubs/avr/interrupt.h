@@ -0,0 +1,22 @@
+/*
+ *  avr/interrupt.h (host)
+ *
+ *  the emulated TWI calls the interrupt routine while the I-flag in SREG is set,
+ *  with deferred interrupts (refer twi_emu.h) at each pass of a wait loop of
+ *  the queue (I2C_WAIT in i2c.c)
+ */
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+#include <avr/io.h>
+
+#define ISR(vector) extern "C" void vector(void)
+#define cli() (SREG &= 0x7F)
+#define sei() (SREG |= 0x80)
+
+namespace TwiEmu {
+	void waitLoop();
+}
+#define I2C_WAIT() TwiEmu::waitLoop()
+
+#endif
@@ -0,0 +1,52 @@
+/*
+ *  avr/io.h (host)
+ *
+ *  TWI register block of an ATmega328P for the host emulation,
+ *  the registers are objects, a write to TWCR starts the emulated action
+ */
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+#ifndef __AVR_ATmega328P__
+#define __AVR_ATmega328P__
+#endif
+
+#define _BV(bit) (1 << (bit))
+
+// TWCR
+#define TWINT	7
+#define TWEA	6
+#define TWSTA	5
+#define TWSTO	4
+#define TWWC	3
+#define TWEN	2
+#define TWIE	0
+// TWSR
+#define TWPS1	1
+#define TWPS0	0
+
+#ifdef __cplusplus
+class EmuRegister {
+public:
+	explicit EmuRegister(void (*onWrite)(uint8_t) = 0) : value(0), onWrite(onWrite) {}
+	operator uint8_t() const { return value; }
+	EmuRegister &operator=(uint8_t v) { if (onWrite) onWrite(v); else value = v; return *this; }
+	EmuRegister &operator=(const EmuRegister &r) { return *this = r.value; }
+	EmuRegister &operator|=(uint8_t v) { return *this = value | v; }
+	EmuRegister &operator&=(uint8_t v) { return *this = value & v; }
+	uint8_t value;
+private:
+	void (*onWrite)(uint8_t);
+};
+
+extern "C++" {
+extern EmuRegister TWCR, TWDR, TWSR, TWBR, SREG;
+}
+#endif
+
+#endif
@@ -0,0 +1,10 @@
+/*
+ *  util/delay.h (host)
+ */
+#ifndef HOST_UTIL_DELAY_H
+#define HOST_UTIL_DELAY_H
+
+#define _delay_ms(ms)
+#define _delay_us(us)
+
+#endif
@@ -0,0 +1,409 @@
+/*
+ *  twi_emu.cpp
+ *
+ *  host emulation of TWI, SH1106 and PCF8574, refer twi_emu.h
+ */
+#include "twi_emu.h"
+
+#include <avr/io.h>
+#include <string.h>
+#include <vector>
+
+// interrupt routine of the library (weak: missing without I2C_ASYNC)
+extern "C" void TWI_vect(void) __attribute__((weak));
+
+static void writeTWCR(uint8_t value);
+static void writeSREG(uint8_t value);
+
+EmuRegister TWCR(writeTWCR);
+EmuRegister TWDR;
+EmuRegister TWSR;
+EmuRegister TWBR;
+EmuRegister SREG(writeSREG);
+
+namespace TwiEmu {
+	EmuSH1106 display;
+	EmuPCF8574 keypad;
+	TwiStats stats;
+	uint8_t displayAddress = 0x3C;
+	uint8_t keypadAddress = 0x21;
+	unsigned long displayMaxClock = 0;
+	unsigned long keypadMaxClock = 0;
+	bool deferInterrupts = false;
+	bool busHeld = false;
+}
+
+using namespace TwiEmu;
+
+//=== bus =====================================================================
+enum BusState { BUS_IDLE, BUS_STARTED, BUS_WRITE, BUS_READ };
+static BusState busState = BUS_IDLE;
+static uint8_t busDevice;		// 7-bit adress of addressed device, 0 = none
+static unsigned long long simMicros;
+static double simFraction;
+static bool inInterrupt;
+
+struct ButtonEvent { unsigned long ms; uint8_t pressed; };
+static std::vector<ButtonEvent> buttonScript;
+
+static void clocks(unsigned long count)
+{
+	stats.bits += count;
+	simFraction += count * 1e6 / busClock();
+	unsigned long whole = (unsigned long)simFraction;
+	simMicros += whole;
+	simFraction -= whole;
+}
+
+static void updateButtons()
+{
+	while (!buttonScript.empty() && buttonScript.front().ms * 1000ULL <= simMicros)
+	{
+		keypad.pressed = buttonScript.front().pressed;
+		buttonScript.erase(buttonScript.begin());
+	}
+}
+
+static bool tooFast(unsigned long maxClock)
+{
+	return maxClock && busClock() > maxClock;
+}
+
+static void busStart()
+{
+	stats.starts++;
+	clocks(1);
+	busState = BUS_STARTED;
+	busDevice = 0;
+}
+
+static void busStop()
+{
+	stats.stops++;
+	clocks(1);
+	busState = BUS_IDLE;
+	busDevice = 0;
+}
+
+// returns TWSR status
+static uint8_t busWrite(uint8_t byte)
+{
+	stats.bytes++;
+	clocks(9);
+	if (busState == BUS_STARTED)
+	{
+		uint8_t addr(byte >> 1);
+		bool read(byte & 0x01);
+		if (addr && addr == displayAddress && !read && !tooFast(displayMaxClock))
+		{
+			busDevice = addr;
+			busState = BUS_WRITE;
+			display.start();
+			return 0x18;
+		}
+		if (addr && addr == keypadAddress && !tooFast(keypadMaxClock))
+		{
+			busDevice = addr;
+			busState = read ? BUS_READ : BUS_WRITE;
+			return read ? 0x40 : 0x18;
+		}
+		stats.nacks++;
+		busState = BUS_WRITE;
+		return read ? 0x48 : 0x20;
+	}
+	if (busState != BUS_WRITE || !busDevice)
+	{
+		stats.nacks++;
+		return 0x30;
+	}
+	if (busDevice == displayAddress)
+		display.write(byte);
+	else
+		keypad.write(byte);
+	return 0x28;
+}
+
+static uint8_t busRead(bool ack, uint8_t &status)
+{
+	stats.bytes++;
+	clocks(9);
+	updateButtons();
+	status = ack ? 0x50 : 0x58;
+	if (busState != BUS_READ)
+		return 0xFF;
+	return keypad.read();
+}
+
+//=== TWI registers ===========================================================
+static bool interruptPending()
+{
+	return TWI_vect && (TWCR.value & _BV(TWINT)) && (TWCR.value & _BV(TWIE)) && (SREG.value & 0x80);
+}
+
+static void runInterrupt()
+{
+	inInterrupt = true;
+	uint8_t sreg(SREG.value);
+	SREG.value &= 0x7F;
+	TWI_vect();
+	SREG.value = sreg;
+	inInterrupt = false;
+}
+
+static void serveInterrupts()
+{
+	if (inInterrupt || deferInterrupts)
+		return;
+	while (interruptPending())
+		runInterrupt();
+}
+
+static void writeTWCR(uint8_t value)
+{
+	bool clearInt(value & _BV(TWINT));
+	TWCR.value = (value & ~_BV(TWINT)) | (TWCR.value & _BV(TWINT));
+	if (!(value & _BV(TWEN)))
+	{
+		// TWI disabled: bus released
+		TWCR.value &= ~_BV(TWINT);
+		busState = BUS_IDLE;
+		return;
+	}
+	if (clearInt)
+	{
+		uint8_t status(0xF8);
+		TWCR.value &= ~_BV(TWINT);
+		if (busHeld)
+			return;		// TWINT isn't set again, TWSTO stays set
+		if (value & _BV(TWSTO))
+		{
+			if (busState != BUS_IDLE)
+				busStop();
+			TWCR.value &= ~_BV(TWSTO);
+			if (value & _BV(TWSTA))
+			{
+				busStart();
+				status = 0x08;
+			}
+		}
+		else if (value & _BV(TWSTA))
+		{
+			status = (busState == BUS_IDLE) ? 0x08 : 0x10;
+			busStart();
+		}
+		else if (busState == BUS_READ)
+		{
+			TWDR.value = busRead(value & _BV(TWEA), status);
+		}
+		else if (busState != BUS_IDLE)
+		{
+			status = busWrite(TWDR.value);
+		}
+		if (status != 0xF8)
+		{
+			TWSR.value = status | (TWSR.value & 0x03);
+			TWCR.value |= _BV(TWINT);
+		}
+	}
+	serveInterrupts();
+}
+
+static void writeSREG(uint8_t value)
+{
+	SREG.value = value;
+	serveInterrupts();
+}
+
+namespace TwiEmu {
+
+unsigned long busClock()
+{
+	static const uint8_t prescaler[] = { 1, 4, 16, 64 };
+	return F_CPU / (16UL + 2UL * TWBR.value * prescaler[TWSR.value & 0x03]);
+}
+
+bool step()
+{
+	if (inInterrupt || !interruptPending())
+		return false;
+	runInterrupt();
+	return true;
+}
+
+void waitLoop()
+{
+	if (deferInterrupts)
+		step();
+}
+
+unsigned long long now()
+{
+	return simMicros;
+}
+
+void advance(unsigned long us)
+{
+	simMicros += us;
+	updateButtons();
+}
+
+void scriptButtons(unsigned long ms, uint8_t pressed)
+{
+	ButtonEvent e = { ms, pressed };
+	buttonScript.push_back(e);
+}
+
+void resetStats()
+{
+	memset(&stats, 0, sizeof(stats));
+	display.commands = display.dataBytes = 0;
+	keypad.reads = keypad.writes = 0;
+}
+
+void reset()
+{
+	display.reset();
+	keypad = EmuPCF8574();
+	buttonScript.clear();
+	displayMaxClock = keypadMaxClock = 0;
+	deferInterrupts = busHeld = false;
+	busState = BUS_IDLE;
+	TWCR.value = TWDR.value = TWSR.value = TWBR.value = 0;
+	SREG.value = 0x80;		// interrupts enabled as at Arduino
+	resetStats();
+}
+
+}
+
+//=== Arduino time ============================================================
+unsigned long millis(void)
+{
+	updateButtons();
+	return (unsigned long)(simMicros / 1000);
+}
+
+unsigned long micros(void)
+{
+	return (unsigned long)simMicros;
+}
+
+//=== SH1106 ==================================================================
+EmuSH1106::EmuSH1106()
+{
+	reset();
+}
+
+void EmuSH1106::reset()
+{
+	memset(ram, 0, sizeof(ram));
+	column = 0;
+	page = 0;
+	startLine = 0;
+	displayOffset = 0;
+	contrast = 0x80;
+	displayOn = false;
+	inverse = false;
+	commands = 0;
+	dataBytes = 0;
+	control = 0xFF;
+	pendingCmd = 0;
+	paramExpected = false;
+}
+
+void EmuSH1106::start()
+{
+	control = 0xFF;
+}
+
+void EmuSH1106::write(uint8_t byte)
+{
+	if (control == 0xFF)
+	{
+		// control byte: Co (bit 7), D/C (bit 6)
+		control = byte;
+		return;
+	}
+	if (control & 0x40)
+	{
+		dataBytes++;
+		if (column < 132)
+			ram[page][column] = byte;
+		if (column < 131)
+			column++;
+	}
+	else
+	{
+		commands++;
+		command(byte);
+	}
+	if (control & 0x80)
+		control = 0xFF;	// Co = 1: next byte is a control byte
+}
+
+void EmuSH1106::command(uint8_t cmd)
+{
+	if (paramExpected)
+	{
+		paramExpected = false;
+		switch (pendingCmd)
+		{
+			case 0x81: contrast = cmd; break;
+			case 0xD3: displayOffset = cmd & 0x3F; break;
+			default: break;
+		}
+		return;
+	}
+	if (cmd <= 0x0F)
+		column = (column & 0xF0) | cmd;
+	else if (cmd <= 0x1F)
+		column = (column & 0x0F) | ((cmd & 0x0F) << 4);
+	else if (cmd >= 0x40 && cmd <= 0x7F)
+		startLine = cmd & 0x3F;
+	else if (cmd >= 0xB0 && cmd <= 0xB7)
+		page = cmd & 0x07;
+	else if (cmd == 0xAE || cmd == 0xAF)
+		displayOn = cmd & 0x01;
+	else if (cmd == 0xA6 || cmd == 0xA7)
+		inverse = cmd & 0x01;
+	else if (cmd == 0x81 || cmd == 0xA8 || cmd == 0xAD || cmd == 0xD3 ||
+	         cmd == 0xD5 || cmd == 0xD9 || cmd == 0xDA || cmd == 0xDB)
+	{
+		// double byte commands
+		pendingCmd = cmd;
+		paramExpected = true;
+	}
+	// other commands have no effect at the emulation
+}
+
+bool EmuSH1106::pixel(uint8_t x, uint8_t y) const
+{
+	uint8_t line((y + startLine + displayOffset) & 0x3F);
+	bool on(ram[line / 8][x + 2] & (1 << (line % 8)));
+	return on != inverse;
+}
+
+bool EmuSH1106::writePBM(const char *fileName) const
+{
+	FILE *f(fopen(fileName, "w"));
+	if (!f)
+		return false;
+	fprintf(f, "P1\n128 64\n");
+	for (uint8_t y = 0; y < 64; y++)
+	{
+		for (uint8_t x = 0; x < 128; x++)
+			fputc(pixel(x, y) ? '1' : '0', f);
+		fputc('\n', f);
+	}
+	fclose(f);
+	return true;
+}
+
+void EmuSH1106::printAscii(FILE *f) const
+{
+	for (uint8_t y = 0; y < 64; y++)
+	{
+		for (uint8_t x = 0; x < 128; x++)
+			fputc(pixel(x, y) ? '#' : '.', f);
+		fputc('\n', f);
+	}
+}
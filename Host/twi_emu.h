@@ -0,0 +1,113 @@
+/*
+ *  twi_emu.h
+ *
+ *  host emulation of the TWI of an ATmega328P with a SH1106 OLED-display
+ *  and a PCF8574 for the buttons at the bus
+ *
+ *  counts bytes, start- and stop-conditions at the bus, the simulated
+ *  time (millis(), micros()) runs with the wire time at the clock set in TWBR
+ *
+ *  the TWI-interrupt (I2C_ASYNC) runs at once when it is due, with
+ *  deferInterrupts only by step() and in the wait loops of the queue,
+ *  so a test sees the queue between the bus actions
+ */
+#ifndef TWI_EMU_H
+#define TWI_EMU_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+struct TwiStats {
+	unsigned long bytes;		// incl. adress bytes
+	unsigned long starts;		// incl. repeated starts
+	unsigned long stops;
+	unsigned long nacks;
+	unsigned long bits;			// SCL clocks incl. start- and stop-condition
+
+	// wire time in us at the given bus clock
+	double micros(unsigned long f_i2c) const { return bits * 1e6 / f_i2c; }
+};
+
+// SH1106: 132 columns, 8 pages, the visible area starts at column 2
+class EmuSH1106 {
+public:
+	EmuSH1106();
+	void reset();
+
+	uint8_t ram[8][132];
+	uint8_t column;
+	uint8_t page;
+	uint8_t startLine;
+	uint8_t displayOffset;
+	uint8_t contrast;
+	bool displayOn;
+	bool inverse;
+
+	// pixel as shown on the display (after start line and display offset)
+	bool pixel(uint8_t x, uint8_t y) const;
+	bool writePBM(const char *fileName) const;
+	void printAscii(FILE *f) const;
+
+	// bus interface
+	void start();
+	void write(uint8_t byte);
+
+	unsigned long commands;
+	unsigned long dataBytes;
+
+private:
+	void command(uint8_t cmd);
+	uint8_t control;		// last control byte, 0xFF: none received
+	uint8_t pendingCmd;		// command waiting for its parameter byte
+	bool paramExpected;
+};
+
+// PCF8574: buttons switch pins to GND
+class EmuPCF8574 {
+public:
+	EmuPCF8574() : latch(0xFF), pressed(0), reads(0), writes(0) {}
+	uint8_t latch;
+	uint8_t pressed;		// bit is set for each button pressed
+	unsigned long reads;
+	unsigned long writes;
+	uint8_t read() { reads++; return latch & ~pressed; }
+	void write(uint8_t byte) { writes++; latch = byte; }
+};
+
+namespace TwiEmu {
+	extern EmuSH1106 display;
+	extern EmuPCF8574 keypad;
+	extern TwiStats stats;
+
+	extern uint8_t displayAddress;	// 7-bit adress, 0 = not connected
+	extern uint8_t keypadAddress;	// 7-bit adress, 0 = not connected
+
+	// highest clock at which the device acknowledges, 0 = any clock
+	extern unsigned long displayMaxClock;
+	extern unsigned long keypadMaxClock;
+
+	// TWI-interrupt runs only by step() and waitLoop()
+	extern bool deferInterrupts;
+	// a device holds SCL low: TWI actions (incl. stop-condition) don't complete
+	extern bool busHeld;
+
+	// runs the TWI-interrupt if it is due, false if not
+	bool step();
+	// wait loop of the queue (I2C_WAIT): one step() with deferInterrupts
+	void waitLoop();
+
+	// bus clock set in TWBR/TWSR
+	unsigned long busClock();
+
+	// simulated time in us (wire time plus advance())
+	unsigned long long now();
+	void advance(unsigned long us);
+
+	// buttons pressed from the given time on (keeps time order)
+	void scriptButtons(unsigned long ms, uint8_t pressed);
+
+	void resetStats();
+	void reset();
+}
+
+#endif
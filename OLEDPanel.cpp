@@ -56,14 +56,283 @@
 
 extern uint8_t I2C_ErrorCode;
 
-OLEDPanel::OLEDPanel() {
+#define SHADOW_CHANGED 0x80	// display differs from shadow
+#define SHADOW_UNKNOWN 0x7F	// glyph of character written directly to display
+
+#define BUF_SIZE 33	// number as text
+
+//=== OLEDShadow ==============================================================
+OLEDShadow::OLEDShadow()
+{
+	reset();
+}
+
+void OLEDShadow::reset()
+{
+	memset(m_cells, 0, sizeof(m_cells));
+	memset(m_attributes, 0, sizeof(m_attributes));
+	memset(m_erased, 0, sizeof(m_erased));
+}
+
+void OLEDShadow::invalidate()
+{
+	for (uint8_t y = 0; y < COUNT_OF_LINES; y++)
+	{
+		for (uint8_t x = 0; x < COUNT_OF_CHARS; x++)
+		{
+			if ((m_cells[y][x] & ~SHADOW_CHANGED) == SHADOW_UNKNOWN)
+				m_cells[y][x] = 0;
+			m_cells[y][x] |= SHADOW_CHANGED;
+		}
+	}
+}
+
+void OLEDShadow::put(uint8_t x, uint8_t y, uint8_t glyph, uint8_t charMode)
+{
+	if (x >= COUNT_OF_CHARS || y >= COUNT_OF_LINES)
+		return;
+	m_erased[y][x / 8] &= ~(1 << (x % 8));
+	uint8_t attribute((charMode & (UNDERLINE | INVERT)) >> 2);
+	uint8_t shift((x % 4) * 2);
+	uint8_t &attributes(m_attributes[y][x / 4]);
+	if (((m_cells[y][x] & ~SHADOW_CHANGED) == glyph) && (((attributes >> shift) & 0x03) == attribute))
+		return;	// no change
+	m_cells[y][x] = glyph | SHADOW_CHANGED;
+	attributes = (attributes & ~(0x03 << shift)) | (attribute << shift);
+}
+
+void OLEDShadow::erase(uint8_t x, uint8_t y)
+{
+	if (x >= COUNT_OF_CHARS || y >= COUNT_OF_LINES)
+		return;
+	// character keeps its glyph, so redrawing the same text after clear sends nothing
+	m_erased[y][x / 8] |= (1 << (x % 8));
+}
+
+void OLEDShadow::forget(uint8_t x, uint8_t y)
+{
+	if (x >= COUNT_OF_CHARS || y >= COUNT_OF_LINES)
+		return;
+	m_erased[y][x / 8] &= ~(1 << (x % 8));
+	m_cells[y][x] = SHADOW_UNKNOWN;
+}
+
+void OLEDShadow::scrollUp()
+{
+	// changes not flushed yet move with their lines
+	memmove(m_cells[0], m_cells[1], sizeof(m_cells) - sizeof(m_cells[0]));
+	memmove(m_attributes[0], m_attributes[1], sizeof(m_attributes) - sizeof(m_attributes[0]));
+	memmove(m_erased[0], m_erased[1], sizeof(m_erased) - sizeof(m_erased[0]));
+	memset(m_cells[COUNT_OF_LINES - 1], 0, sizeof(m_cells[0]));
+	memset(m_attributes[COUNT_OF_LINES - 1], 0, sizeof(m_attributes[0]));
+	memset(m_erased[COUNT_OF_LINES - 1], 0, sizeof(m_erased[0]));
+}
+
+uint8_t OLEDShadow::glyph(uint8_t x, uint8_t y, uint8_t *pCharMode)
+{
+	*pCharMode = NORMALSIZE;
+	if (x >= COUNT_OF_CHARS || y >= COUNT_OF_LINES)
+		return 0;
+	uint8_t glyph(m_cells[y][x] & ~SHADOW_CHANGED);
+	if ((m_erased[y][x / 8] & (1 << (x % 8))) || (glyph == SHADOW_UNKNOWN))
+		return 0;	// blank
+	*pCharMode = charMode(x, y);
+	return glyph;
+}
+
+bool OLEDShadow::changed(uint8_t x, uint8_t y)
+{
+	if (x >= COUNT_OF_CHARS || y >= COUNT_OF_LINES)
+		return false;
+	return (m_cells[y][x] & SHADOW_CHANGED) || (m_erased[y][x / 8] & (1 << (x % 8)));
+}
+
+void OLEDShadow::flush()
+{
+	for (uint8_t y = 0; y < COUNT_OF_LINES; y++)
+	{
+		// erased characters become blank
+		for (uint8_t x = 0; x < COUNT_OF_CHARS; x++)
+		{
+			if (m_erased[y][x / 8] & (1 << (x % 8)))
+				put(x, y, 0, NORMALSIZE);
+		}
+
+		uint8_t x(0);
+		while (x < COUNT_OF_CHARS)
+		{
+			if (!(m_cells[y][x] & SHADOW_CHANGED))
+			{
+				++x;
+				continue;
+			}
+			// find end of changed characters,
+			// a single unchanged character in between is cheaper to send than a new adressing
+			uint8_t end(x + 1);
+			while (end < COUNT_OF_CHARS)
+			{
+				if (m_cells[y][end] & SHADOW_CHANGED)
+					++end;
+				else if ((end + 1 < COUNT_OF_CHARS) && (m_cells[y][end + 1] & SHADOW_CHANGED) && (m_cells[y][end] != SHADOW_UNKNOWN))
+					end += 2;
+				else
+					break;
+			}
+			// send them in one transmission
+			lcd_gotoxy(x, y);
+			for (; x < end; x++)
+			{
+				m_cells[y][x] &= ~SHADOW_CHANGED;
+				lcd_putGlyph(m_cells[y][x], charMode(x, y));
+			}
+			lcd_endGlyphs();
+		}
+	}
+}
+
+uint8_t OLEDShadow::charMode(uint8_t x, uint8_t y)
+{
+	return ((m_attributes[y][x / 4] >> ((x % 4) * 2)) & 0x03) << 2;
+}
+
+//=== OLEDField ===============================================================
+OLEDField::OLEDField(uint8_t x, uint8_t y, uint8_t width, int iType, uint8_t align, uint8_t charMode)
+	: m_x(x)
+	, m_y(y)
+	, m_width(width < FIELD_MAX_WIDTH ? width : FIELD_MAX_WIDTH)
+	, m_align(align)
+	, m_charMode(charMode & (UNDERLINE | INVERT))
+	, m_iType(iType)
+{
+	invalidate();
+}
+
+void OLEDField::invalidate()
+{
+	memset(m_glyphs, 0xff, sizeof(m_glyphs));
+	m_ui8Generation = lcd_generation();
+}
+
+void OLEDField::update(unsigned long ulValue)
+{
+	char buf[BUF_SIZE]; // Assumes 8-bit chars plus zero byte.
+	update(OLEDPanel::formatNumber((char*)&(buf), BUF_SIZE, ulValue, m_iType));
+}
+
+void OLEDField::update(long lValue)
+{
+	char buf[BUF_SIZE]; // Assumes 8-bit chars plus zero byte.
+	bool bNegative(((m_iType & FMT_BASE_MASK) == DEC) && (lValue < 0));
+	unsigned long ulValue(bNegative ? -(unsigned long)lValue : (unsigned long)lValue);
+	update(OLEDPanel::formatNumber((char*)&(buf), BUF_SIZE, ulValue, m_iType, bNegative));
+}
+
+void OLEDField::update(const char *pText)
+{
+	if ((m_x + m_width) > COUNT_OF_CHARS || m_y > (COUNT_OF_LINES - 1))
+		return;
+
+	// text aligned in the field, rest is blank (glyph 0)
+	uint8_t glyphs[FIELD_MAX_WIDTH];
+	memset(glyphs, 0, sizeof(glyphs));
+	uint8_t iCount(0);
+	while (pText[iCount] && (iCount < m_width))
+		++iCount;
+	uint8_t iStart(m_align == FIELD_RIGHT ? m_width - iCount : m_align == FIELD_CENTER ? (m_width - iCount) / 2 : 0);
+	for (uint8_t i = 0; i < iCount; i++)
+	{
+		uint8_t glyph(lcd_charIndex((unsigned char)pText[i]));
+		glyphs[iStart + i] = (glyph == 0xff) ? 0 : glyph;
+	}
+	// display was cleared or scrolled since the last update
+	if (m_ui8Generation != lcd_generation())
+		invalidate();
+
+	uint8_t cursorX, cursorY;
+	lcd_get_xpix_y(&cursorX, &cursorY);
+	bool bOpen(false);
+	uint8_t sentEnd(0);	// last column send
+	for (uint8_t i = 0; i < m_width; i++)
+	{
+		if (glyphs[i] == m_glyphs[i])
+			continue;
+		// columns which differ
+		uint8_t first(0);
+		uint8_t last(CHAR_WIDTH - 1);
+		if (m_glyphs[i] != 0xff)
+		{
+			while ((first < CHAR_WIDTH) && (lcd_glyphColumn(glyphs[i], first, m_charMode) == lcd_glyphColumn(m_glyphs[i], first, m_charMode)))
+				++first;
+			if (first == CHAR_WIDTH)
+				continue;	// other glyph, same columns
+			while (lcd_glyphColumn(glyphs[i], last, m_charMode) == lcd_glyphColumn(m_glyphs[i], last, m_charMode))
+				--last;
+		}
+		uint8_t column(i * CHAR_WIDTH + first);
+		if (bOpen && (column - sentEnd - 1 <= FIELD_GAP_COLUMNS))
+			column = sentEnd + 1;	// same transmission
+		else
+		{
+			if (bOpen)
+				lcd_endGlyphs();
+			lcd_goto_xpix_y(m_x * CHAR_WIDTH + column, m_y);
+			bOpen = true;
+		}
+		sentEnd = i * CHAR_WIDTH + last;
+		sendColumns(glyphs, column, sentEnd);
+	}
+	if (bOpen)
+		lcd_endGlyphs();
+	memcpy(m_glyphs, glyphs, sizeof(m_glyphs));
+	// text of OLEDPanel continues where it was
+	lcd_goto_xpix_y(cursorX, cursorY);
+}
+
+// columns first..last of the field
+void OLEDField::sendColumns(const uint8_t glyphs[], uint8_t first, uint8_t last)
+{
+	uint8_t i(first / CHAR_WIDTH);
+	uint8_t column(first - i * CHAR_WIDTH);
+	while (first <= last)
+	{
+		uint8_t end(CHAR_WIDTH - 1);
+		if (last - first < end - column)
+			end = column + last - first;
+		lcd_putGlyphColumns(glyphs[i], m_charMode, column, end);
+		first += end - column + 1;
+		column = 0;
+		++i;
+	}
+}
+
+//=== OLEDPanel ===============================================================
+
+OLEDPanel::OLEDPanel()
+	: debouncer_OK(debouncer, 0)
+	, debouncer_Right(debouncer, 1)
+	, debouncer_Down(debouncer, 2)
+	, debouncer_Up(debouncer, 3)
+	, debouncer_Left(debouncer, 4)
+	, debouncer_F1(debouncer, 5)
+	, debouncer_F2(debouncer, 6)
+	, debouncer_F3(debouncer, 7)
+{
 	m_ui8KeyAddr = 0;
+	m_bConsole = false;
 	m_bCursorOn = false;
+	m_bCursorShown = false;
+	m_ui8CursorStyle = CURSOR_MACRON;
 	m_bBlinken1Hz = false;
 	m_ulpreviousMillis = 0;
+	m_ulProbeMillis = 0;
 	m_ui8KeyAddr = 0;
+	m_ui8CharMode = NORMALSIZE;
 	cursorPos.x = 0;
 	cursorPos.y = 0;
+	m_pShadow = 0;
+	shadowPos.x = 0;
+	shadowPos.y = 0;
+	m_ui8WriteCount = 0;
 }
 
 uint16_t OLEDPanel::detect_i2c(uint8_t ui8_keyAddr)
@@ -86,9 +355,79 @@ uint16_t OLEDPanel::detect_i2c(uint8_t ui8_keyAddr)
 	return 0;
 }
 
+uint32_t OLEDPanel::setBusClock(uint32_t ulClock, bool bProbe)
+{
+	if (!bProbe)
+		return i2c_setClock(ulClock);
+
+	// Fast-mode Plus, Fast-mode, Standard-mode
+	static const uint32_t standardClocks[] = { 1000000UL, 400000UL, 100000UL };
+	const uint8_t iCount(sizeof(standardClocks) / sizeof(standardClocks[0]));
+	uint8_t i(0);
+	i2c_setClock(ulClock);
+	while (!probeBus())
+	{
+		// try next lower standard clock
+		while ((i < iCount) && (standardClocks[i] >= i2c_getClock()))
+			++i;
+		if (i == iCount)
+			break; // no answer at all, keep lowest clock
+		i2c_setClock(standardClocks[i]);
+	}
+	return i2c_getClock();
+}
+
+// offline devices are probed every BUS_REPROBE_TIME ms and initialized on reconnect
+void OLEDPanel::checkBus()
+{
+	bool bDisplayOnline(i2c_online(LCD_I2C_ADR << 1));
+	bool bKeysOnline(!m_ui8KeyAddr || i2c_online(m_ui8KeyAddr));
+	if (bDisplayOnline && bKeysOnline)
+		return;
+	if ((millis() - m_ulProbeMillis) < BUS_REPROBE_TIME)
+		return;
+	m_ulProbeMillis = millis();
+
+	if (!bDisplayOnline && i2c_probe(LCD_I2C_ADR << 1))
+	{
+		i2c_setOnline(LCD_I2C_ADR << 1);
+		I2C_ErrorCode = 0;
+		lcd_reinit(LCD_DISP_ON);
+		lcd_charMode(m_ui8CharMode);
+		m_bCursorShown = false;
+		// content of display is lost, shadow sends all again
+		if (m_pShadow)
+			m_pShadow->invalidate();
+	}
+	if (!bKeysOnline && i2c_probe(m_ui8KeyAddr + 1))
+	{
+		i2c_setOnline(m_ui8KeyAddr);
+		I2C_ErrorCode = 0;
+		initButtons();
+	}
+}
+
+// true if all devices acknowledge BUS_PROBE_COUNT times at the active clock
+bool OLEDPanel::probeBus()
+{
+	for (uint8_t i = 0; i < BUS_PROBE_COUNT; i++)
+	{
+		if (!i2c_probe(LCD_I2C_ADR << 1))
+			return false;
+		if (m_ui8KeyAddr && !i2c_probe(m_ui8KeyAddr + 1))
+			return false;
+	}
+	return true;
+}
+
 void OLEDPanel::begin(uint8_t /*cols*/, uint8_t /*rows*/)
 {
 	lcd_init(LCD_DISP_ON);    // init lcd and turn on
+	m_bCursorShown = false;
+	if (m_pShadow)
+		m_pShadow->reset();
+	shadowPos.x = 0;
+	shadowPos.y = 0;
 
 	initButtons();
 }
@@ -103,15 +442,10 @@ void OLEDPanel::initButtons()
 	  i2c_byte(0b11111111); // all inputs
 	  i2c_stop();
 
-		// After setting up the button, setup the Bounce instances :
-		debouncer_OK.attach(m_ui8KeyAddr, 0, DEBOUNCE_TIME);
-		debouncer_Right.attach(m_ui8KeyAddr, 1, DEBOUNCE_TIME);
-		debouncer_Down.attach(m_ui8KeyAddr, 2, DEBOUNCE_TIME);
-		debouncer_Up.attach(m_ui8KeyAddr, 3, DEBOUNCE_TIME);
-		debouncer_Left.attach(m_ui8KeyAddr, 4, DEBOUNCE_TIME);
-		debouncer_F1.attach(m_ui8KeyAddr, 5, DEBOUNCE_TIME);
-		debouncer_F2.attach(m_ui8KeyAddr, 6, DEBOUNCE_TIME);
-		debouncer_F3.attach(m_ui8KeyAddr, 7, DEBOUNCE_TIME);
+		// After setting up the button, setup the Bounce instance for all buttons :
+		debouncer.attach(m_ui8KeyAddr, DEBOUNCE_TIME);
+		// buttons start with the state read at attach
+		followButtons();
 	}
 }
 
@@ -119,18 +453,26 @@ void OLEDPanel::updateDebounce()
 {
 	if (m_ui8KeyAddr)
 	{
-		// Update the Bounce instances :
-		debouncer_OK.update();
-		debouncer_Right.update();
-		debouncer_Down.update();
-		debouncer_Up.update();
-		debouncer_Left.update();
-		debouncer_F1.update();
-		debouncer_F2.update();
-		debouncer_F3.update();
+		// Update the Bounce instance (one read of the PCF8574 for all buttons) :
+		checkBus();
+		debouncer.update();
+		followButtons();
 	}
 }
 
+// debouncer_... take the state of the port, fell()/rose() of the port stay valid
+void OLEDPanel::followButtons()
+{
+	debouncer_OK.follow();
+	debouncer_Right.follow();
+	debouncer_Down.follow();
+	debouncer_Up.follow();
+	debouncer_Left.follow();
+	debouncer_F1.follow();
+	debouncer_F2.follow();
+	debouncer_F3.follow();
+}
+
 
 void OLEDPanel::setKeyAddr(uint8_t ui8_keyAddr, bool bInit)
 {
@@ -142,7 +484,17 @@ void OLEDPanel::setKeyAddr(uint8_t ui8_keyAddr, bool bInit)
  
 void OLEDPanel::clear()
 {
+	flushWrite();
+	if (m_pShadow)
+	{
+		// only characters which are not written again are blanked by flush
+		for (uint8_t y = 0; y < COUNT_OF_LINES; y++)
+			clear(0, y, COUNT_OF_CHARS);
+		gotoxy(0, 0);
+		return;
+	}
 	lcd_clrscr();
+	m_bCursorShown = false;
 }
 
 void OLEDPanel::clearLine(uint8_t y)
@@ -160,17 +512,30 @@ void OLEDPanel::clear(uint8_t x, uint8_t y, uint8_t iCount)
 {
 	if((x + iCount) > COUNT_OF_CHARS || y > (COUNT_OF_LINES - 1))
 		return;
-	lcd_gotoxy(x, y);
+	flushWrite();
+	if (m_pShadow)
+	{
+		for (uint8_t i = 0; i < iCount; i++)
+			m_pShadow->erase(x + i, y);
+	}
+	else
+	{
+		lcd_gotoxy(x, y);
+		lcd_data_repeat(0x00, CHAR_WIDTH * iCount);
+	}
+	gotoxy(x/* + iCount*/, y);
+}
 
-	register uint8_t iSize(6 * iCount);
-	uint8_t clearLine[iSize];
-	memset(clearLine, 0x00, iSize);
-	lcd_data(clearLine, sizeof(clearLine));
-	lcd_gotoxy(x/* + iCount*/, y);
+void OLEDPanel::setConsole(bool bConsole)
+{
+	flushWrite();
+	m_bConsole = bConsole;
+	lcd_consoleMode(bConsole ? YES : 0);
 }
 
 void OLEDPanel::setCharMode(bool bDouble, bool bInvert, bool bUnderline)
 {
+  flushWrite();
   uint8_t uCharMode(NORMALSIZE);
   if (bDouble)
     uCharMode = DOUBLESIZE;
@@ -178,113 +543,238 @@ void OLEDPanel::setCharMode(bool bDouble, bool bInvert, bool bUnderline)
     uCharMode |= UNDERLINE;
   if (bInvert)
     uCharMode |= INVERT;
+	m_ui8CharMode = uCharMode;
 	lcd_charMode(uCharMode);
 }
 
+// with a shadow text is written to the shadow,
+// flush sends the changed characters to the display
+void OLEDPanel::setShadow(OLEDShadow *pShadow)
+{
+	flushWrite();
+	m_pShadow = pShadow;
+	if (m_pShadow)
+	{
+		lcd_clrscr();
+		m_pShadow->reset();
+		gotoxy(0, 0);
+	}
+}
+
+void OLEDPanel::flush()
+{
+	flushWrite();
+	if (m_pShadow)
+		m_pShadow->flush();
+}
+
+#if defined GRAPHICMODE
+// region at the right edge includes the columns right of the last character
+static uint8_t regionColumns(uint8_t x, uint8_t w)
+{
+	return (x + w == COUNT_OF_CHARS) ? DISPLAY_WIDTH - x * CHAR_WIDTH : w * CHAR_WIDTH;
+}
+#endif
+
+bool OLEDPanel::saveRegion(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t *pStorage)
+{
+	flushWrite();
+	if ((x + w) > COUNT_OF_CHARS || (y + h) > COUNT_OF_LINES)
+		return false;
+#if defined GRAPHICMODE
+	uint8_t ui8Columns(regionColumns(x, w));
+	for (uint8_t i = 0; i < h; i++, pStorage += ui8Columns)
+		lcd_read_buffer(x * CHAR_WIDTH, y + i, ui8Columns, pStorage);
+#else
+	if (!m_pShadow)
+		return false;
+	// glyphs, then charModes with 2 bits per character
+	uint8_t *pModes(pStorage + w * h);
+	memset(pModes, 0, (w * h + 3) / 4);
+	uint16_t i(0);
+	for (uint8_t line = y; line < y + h; line++)
+	{
+		for (uint8_t column = x; column < x + w; column++, i++)
+		{
+			uint8_t ui8CharMode;
+			pStorage[i] = m_pShadow->glyph(column, line, &ui8CharMode);
+			pModes[i / 4] |= ((ui8CharMode & (UNDERLINE | INVERT)) >> 2) << ((i % 4) * 2);
+		}
+	}
+#endif
+	return true;
+}
+
+bool OLEDPanel::restoreRegion(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t *pStorage)
+{
+	flushWrite();
+	if ((x + w) > COUNT_OF_CHARS || (y + h) > COUNT_OF_LINES)
+		return false;
+#if defined GRAPHICMODE
+	uint8_t ui8Columns(regionColumns(x, w));
+	for (uint8_t i = 0; i < h; i++, pStorage += ui8Columns)
+		lcd_write_buffer(x * CHAR_WIDTH, y + i, ui8Columns, pStorage);
+#else
+	if (!m_pShadow)
+		return false;
+	// shadow marks only characters which differ
+	const uint8_t *pModes(pStorage + w * h);
+	uint16_t i(0);
+	for (uint8_t line = y; line < y + h; line++)
+	{
+		for (uint8_t column = x; column < x + w; column++, i++)
+			m_pShadow->put(column, line, pStorage[i], ((pModes[i / 4] >> ((i % 4) * 2)) & 0x03) << 2);
+	}
+#endif
+	return true;
+}
+
 void OLEDPanel::noCursor()
 {
+	flushWrite();
+	if (m_bCursorShown)
+		drawCursor(false);
 	m_bCursorOn = false;
-	clearToEOL(0, cursorPos.y + 1);
 }
 
-void OLEDPanel::cursor(uint8_t x, uint8_t y)
+// only the cell of the old and of the new cursor are send,
+// nothing if the cursor is already there (it keeps blinking)
+void OLEDPanel::cursor(uint8_t x, uint8_t y, uint8_t ui8Style)
 {
+	flushWrite();
+	// text under the cursor is known by the shadow only
+	if (!m_pShadow)
+		ui8Style = CURSOR_MACRON;
+	if (m_bCursorOn && (cursorPos.x == x) && (cursorPos.y == y) && (m_ui8CursorStyle == ui8Style))
+	{
+		gotoxy(x, y);
+		return;
+	}
+	if (m_bCursorShown)
+		drawCursor(false);
 	m_bCursorOn = true;
+	m_ui8CursorStyle = ui8Style;
 	cursorPos.x = x;
 	cursorPos.y = y;
-  clearToEOL(0, cursorPos.y + 1);
-	lcd_gotoxy(cursorPos.x, cursorPos.y + 1);
-	lcd_putc(0xAF);  // (Macron = 'Overline')
-	lcd_gotoxy(cursorPos.x, cursorPos.y);
+	// cursor starts visible
+	m_ulpreviousMillis = millis();
+	m_bBlinken1Hz = true;
+	drawCursor(true);
+	gotoxy(cursorPos.x, cursorPos.y);
 }
 
 //needs to be called cyclic e.g. to generate 1-Hz-puls
 void OLEDPanel::refresh()
 {
-	if (millis() - m_ulpreviousMillis > 500)
+	flushWrite();
+	bool bToggled(false);
+	if (millis() - m_ulpreviousMillis > CURSOR_BLINK_TIME)
 	{
 		m_ulpreviousMillis = millis();   // keep actual timevalue
 		// change status:
 		m_bBlinken1Hz = !m_bBlinken1Hz;
+		bToggled = true;
 	}
+	checkBus();
+	// flush overwrites the cursor if its cell has changed
+	bool bCursorChanged(m_bCursorOn && m_pShadow &&
+		m_pShadow->changed(cursorPos.x, cursorPos.y + (m_ui8CursorStyle == CURSOR_MACRON ? 1 : 0)));
+	flush();
+	if (m_bCursorOn && (bToggled || (bCursorChanged && m_bCursorShown)))
+		drawCursor(m_bBlinken1Hz);
 }
 
 void OLEDPanel::setCursor(uint8_t x, uint8_t y)
 {
-	lcd_gotoxy(x, y);
+	checkBus();
+	gotoxy(x, y);
 }
 
+// lcd_puts/lcd_puts_p send all glyphs of a line in one transmission
 size_t OLEDPanel::print(const __FlashStringHelper *pText)
 {
-	// count chars to display
-	PGM_P p1(reinterpret_cast<PGM_P>(pText));
-	register uint8_t c;
-	register uint8_t iCount(0);
-	while ((c = pgm_read_byte(p1++)))
-	{
-		lcd_putc((unsigned char)(c));
-		++iCount;
-	}
-
-	return iCount;
+	flushWrite();
+	if (m_pShadow)
+		return putsShadow(reinterpret_cast<PGM_P>(pText), true);
+	lcd_puts_p(reinterpret_cast<PGM_P>(pText));
+	return countChar(pText);
 }
 
 size_t OLEDPanel::print(const char *pText)
 {
-	// count chars to display
-	register uint8_t iCount(0);
-	while (*pText)
-	{
-		lcd_putc((unsigned char)(*pText++));
-		++iCount;
-	}
-
-	return iCount;
+	flushWrite();
+	if (m_pShadow)
+		return putsShadow(pText, false);
+	lcd_puts(pText);
+	return countChar(pText);
 }
 
 size_t OLEDPanel::print(const String& s)
 {
-	// count chars to display
-	register uint8_t iCount(0);
-	for (uint16_t i = 0; i < s.length(); i++)
-	{
-		lcd_putc((unsigned char)(s[i]));
-		++iCount;
-	}
-
-	return iCount;
+	flushWrite();
+	if (m_pShadow)
+		return putsShadow(s.c_str(), false);
+	lcd_puts(s.c_str());
+	return s.length();
 }
 
 size_t OLEDPanel::print(char ch)
 {
-	lcd_putc((unsigned char)(ch));
+	flushWrite();
+	if (m_pShadow)
+		putcShadow((unsigned char)(ch));
+	else
+		lcd_putc((unsigned char)(ch));
 	return 1;
 }
 
 size_t OLEDPanel::print(uint8_t x, uint8_t y, char ch)
 {
-	lcd_gotoxy(x, y);
-	lcd_putc((unsigned char)(ch));
-	return 1;
+	gotoxy(x, y);
+	return print(ch);
 }
 
-#define BUF_SIZE 33
+#if ARDUINO >= 100
+// whole buffer of Print::print(...) in one transmission
+size_t OLEDPanel::write(const uint8_t *buffer, size_t size)
+{
+	for (size_t i = 0; i < size; i++)
+		bufferChar(buffer[i]);
+	flushWrite();
+	return size;
+}
+#endif
+
 size_t OLEDPanel::print(uint8_t ui8Value, int iType)
 {
 	char buf[BUF_SIZE]; // Assumes 8-bit chars plus zero byte.
-	return print(intToAscii((char*)&(buf), BUF_SIZE, (unsigned long)ui8Value, iType));
+	return print(formatNumber((char*)&(buf), BUF_SIZE, (unsigned long)ui8Value, iType));
 }
 
 size_t OLEDPanel::print(uint16_t ui16Value, int iType)
 {
 	char buf[BUF_SIZE]; // Assumes 8-bit chars plus zero byte.
-	return print(intToAscii((char*)&(buf), BUF_SIZE, (unsigned long)ui16Value, iType));
+	return print(formatNumber((char*)&(buf), BUF_SIZE, (unsigned long)ui16Value, iType));
 }
 
 size_t OLEDPanel::print(unsigned long ulValue, int iType)
 {
 	char buf[BUF_SIZE]; // Assumes 8-bit chars plus zero byte.
-	return print(intToAscii((char*)&(buf), BUF_SIZE, ulValue, iType));
+	return print(formatNumber((char*)&(buf), BUF_SIZE, ulValue, iType));
+}
+
+size_t OLEDPanel::print(int iValue, int iType)
+{
+	return print((long)iValue, iType);
+}
+
+// negative values with '-' at DEC, else as two's complement like Print
+size_t OLEDPanel::print(long lValue, int iType)
+{
+	char buf[BUF_SIZE]; // Assumes 8-bit chars plus zero byte.
+	bool bNegative(((iType & FMT_BASE_MASK) == DEC) && (lValue < 0));
+	unsigned long ulValue(bNegative ? -(unsigned long)lValue : (unsigned long)lValue);
+	return print(formatNumber((char*)&(buf), BUF_SIZE, ulValue, iType, bNegative));
 }
 
 // output text centered in line y
@@ -313,7 +803,7 @@ size_t OLEDPanel::printc(uint8_t y, const char *pText)
 size_t OLEDPanel::printc(uint8_t x, uint8_t y, unsigned long ulValue, int iType)
 {
 	char buf[BUF_SIZE]; // Assumes 8-bit chars plus zero byte.
-	char *pText(intToAscii((char*)&(buf), BUF_SIZE, ulValue, iType));
+	char *pText(formatNumber((char*)&(buf), BUF_SIZE, ulValue, iType));
 	
 	if(y != 255)
 	{
@@ -323,7 +813,7 @@ size_t OLEDPanel::printc(uint8_t x, uint8_t y, unsigned long ulValue, int iType)
 				return 0;
 		}
 		else
-			lcd_gotoxy(x, y);
+			gotoxy(x, y);
 	}
 	// output text to display
 	return print(pText);
@@ -343,6 +833,7 @@ size_t OLEDPanel::printr(uint8_t y, uint8_t iMaxChar, const __FlashStringHelper
 // bit is set for each button pressed
 uint8_t OLEDPanel::readButtons()
 {
+   checkBus();
    register uint8_t iRetValue(0xff);
    if(m_ui8KeyAddr)
    {
@@ -353,50 +844,73 @@ uint8_t OLEDPanel::readButtons()
 	return ~iRetValue; // since buttons are switch to GND, we invert the state
 }
 
+bool OLEDPanel::isOnline()
+{
+	checkBus();
+	return i2c_online(LCD_I2C_ADR << 1);
+}
+
 void OLEDPanel::printOuterFrame()
 {
+	flushWrite();
+	if (m_pShadow)
+	{
+		// frame is written directly to display
+		for (uint8_t x = 0; x < COUNT_OF_CHARS; x++)
+		{
+			m_pShadow->forget(x, 0);
+			m_pShadow->forget(x, COUNT_OF_LINES - 1);
+		}
+		for (uint8_t y = 1; y < (COUNT_OF_LINES - 1); y++)
+		{
+			m_pShadow->forget(0, y);
+			m_pShadow->forget(COUNT_OF_CHARS - 1, y);
+		}
+	}
+
+
 	// upper frameline
 	lcd_gotoxy(0, 0);
-	i2c_start(LCD_I2C_ADR << 1);
-	i2c_byte(0x40);	// 0x00 for command, 0x40 for data
-	i2c_byte(0xFF);
-	for (uint8_t i = 1; i < (DISPLAY_WIDTH - 1); i++)
-		i2c_byte(0x01);
-	i2c_byte(0xFF);
-	i2c_stop();
+	lcd_data_start();
+	i2c_queueByte(0xFF);
+	i2c_queueRepeat(0x01, DISPLAY_WIDTH - 2);
+	i2c_queueByte(0xFF);
+	i2c_queueStop();
 
 	// border lines
 	for (uint8_t i = 1; i < (COUNT_OF_LINES - 1); i++)
 	{
 		// left border
 		lcd_gotoxy(0, i);
-		i2c_start(LCD_I2C_ADR << 1);
-		i2c_byte(0x40);	// 0x00 for command, 0x40 for data
-		i2c_byte(0xFF);
-		i2c_stop();
+		lcd_data_start();
+		i2c_queueByte(0xFF);
+		i2c_queueStop();
 
 		// right border
 		lcd_gotoxy(COUNT_OF_CHARS - 1, i);
-		i2c_start(LCD_I2C_ADR << 1);
-		i2c_byte(0x40);	// 0x00 for command, 0x40 for data
-		for (uint8_t j = 0; j <= CHAR_WIDTH; j++)
-			i2c_byte(0x00);
-		i2c_byte(0xFF);
-		i2c_stop();
+		lcd_data_start();
+		i2c_queueRepeat(0x00, CHAR_WIDTH + 1);
+		i2c_queueByte(0xFF);
+		i2c_queueStop();
 	}
 
 	// lower frameline
 	lcd_gotoxy(0, COUNT_OF_LINES - 1);
-	i2c_start(LCD_I2C_ADR << 1);
-	i2c_byte(0x40);	// 0x00 for command, 0x40 for data
-	i2c_byte(0xFF);
-	for (uint8_t i = 1; i < (DISPLAY_WIDTH - 1); i++)
-		i2c_byte(0x80);
-	i2c_byte(0xFF);
-	i2c_stop();
+	lcd_data_start();
+	i2c_queueByte(0xFF);
+	i2c_queueRepeat(0x80, DISPLAY_WIDTH - 2);
+	i2c_queueByte(0xFF);
+	i2c_queueStop();
 }
 
 //=== static functions ========================================================
+// 32 bit division is a library call at AVR (some hundred cycles per digit):
+// DEC subtracts powers of ten, HEX/OCT/BIN shift
+static const uint32_t powersOfTen[] PROGMEM = {
+	1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL,
+	10000UL, 1000UL, 100UL, 10UL
+};
+
 char* OLEDPanel::intToAscii(char *buf, uint8_t len, unsigned long n, uint8_t base)
 {
 	char *str(&buf[len-1]);
@@ -404,13 +918,104 @@ char* OLEDPanel::intToAscii(char *buf, uint8_t len, unsigned long n, uint8_t bas
 	// prevent crash if called with base == 1
 	if (base < BIN)
 		base = DEC;
+
+	// count of digits
+	const uint8_t iPowers(sizeof(powersOfTen) / sizeof(powersOfTen[0]));
+	uint8_t i(0);
+	if (base == DEC)
+	{
+		while ((i < iPowers) && (n < pgm_read_dword(&powersOfTen[i])))
+			++i;
+	}
+	// buffer too small: lower digits only by division
+	if ((base == DEC) && (iPowers + 1 - i < len))
+	{
+		str -= iPowers + 1 - i;
+		char *pDigit(str);
+		if (!(n >> 16))
+		{
+			// 16 bit is enough for most counters
+			uint16_t n16(n);
+			for (; i < iPowers; i++)
+			{
+				uint16_t power((uint16_t)pgm_read_dword(&powersOfTen[i]));
+				char c('0');
+				while (n16 >= power)
+				{
+					n16 -= power;
+					++c;
+				}
+				*pDigit++ = c;
+			}
+			*pDigit = '0' + n16;
+			return str;
+		}
+		for (; i < iPowers; i++)
+		{
+			uint32_t power(pgm_read_dword(&powersOfTen[i]));
+			char c('0');
+			while (n >= power)
+			{
+				n -= power;
+				++c;
+			}
+			*pDigit++ = c;
+		}
+		*pDigit = '0' + (uint8_t)n;
+		return str;
+	}
+
+	uint8_t iShift(base == HEX ? 4 : base == OCT ? 3 : base == BIN ? 1 : 0);
+	if (iShift)
+	{
+		uint8_t iMask(base - 1);
+		do
+		{
+			uint8_t c((uint8_t)n & iMask);
+			n >>= iShift;
+			*--str = c < 10 ? c + '0' : c + 'A' - 10;
+			--len;
+		} while(n && (len > 1));
+		return str;
+	}
+
 	do
 	{
 		char c(n % base);
 		n /= base;
 		*--str = c < 10 ? c + '0' : c + 'A' - 10;
 		--len;
-	} while(n && (len != 0));
+	} while(n && (len > 1));
+	return str;
+}
+
+char* OLEDPanel::formatNumber(char *buf, uint8_t len, unsigned long n, int iType, bool bNegative)
+{
+	uint8_t base(iType & FMT_BASE_MASK);
+	uint8_t iWidth((iType >> 8) & 0x0F);
+	uint8_t iDecimals((iType >> 12) & 0x07);
+	char *str(intToAscii(buf, len, n, base));
+	if (base == DEC && iDecimals)
+	{
+		// at least one digit before the point
+		while (((uint8_t)(&buf[len-1] - str) <= iDecimals) && (str > buf))
+			*--str = '0';
+		if (str > buf)
+		{
+			uint8_t iInteger(&buf[len-1] - str - iDecimals);
+			memmove(str - 1, str, iInteger);
+			--str;
+			str[iInteger] = '.';
+		}
+	}
+	if (bNegative && !(iType & FMT_ZERO) && (str > buf))
+		*--str = '-';
+	// sign goes in front of zeros
+	uint8_t iPadding(bNegative && (iType & FMT_ZERO) ? 1 : 0);
+	while (((uint8_t)(&buf[len-1] - str) + iPadding < iWidth) && (str > buf))
+		*--str = (iType & FMT_ZERO) ? '0' : ' ';
+	if (iPadding && (str > buf))
+		*--str = '-';
 	return str;
 }
 
@@ -442,18 +1047,17 @@ bool OLEDPanel::setStartPositionForCenterText(uint8_t y, uint8_t iCount)
   if (y > (COUNT_OF_LINES - 1))
     return false; // out of display
 
-	// TODO ZIM: not shure why "lcd_gotoxy(0, y)" is neccessary
-	lcd_gotoxy(0, y);
+  flushWrite();
+  if (m_pShadow)
+  {
+    // shadow keeps whole characters only
+    gotoxy(iCount < COUNT_OF_CHARS ? (COUNT_OF_CHARS - iCount) / 2 : 0, y);
+    return true;
+  }
 
-  // calculate startposition for text
-	uint8_t x((DISPLAY_WIDTH - (iCount * CHAR_WIDTH)) / 2);
-	// the following 'lcd_command' is similar to 'lcd_gotoxy')
-#if defined SSD1306
-	uint8_t commandSequence[] = {(uint8_t)(0xb0+y), 0x21, x, 0x7f};
-#elif defined SH1106
-	uint8_t commandSequence[] = {(uint8_t)(0xb0+(y & 0x0f)), 0x21, (uint8_t)(0x00+((2+x) & (0x0f))), (uint8_t)(0x10+( ((2+x) & (0xf0)) >> 4 )), 0x7f};
-#endif
-	lcd_command(commandSequence, sizeof(commandSequence));
+  // calculate startposition for text, position is send with the text
+	uint8_t x(iCount < COUNT_OF_CHARS ? (DISPLAY_WIDTH - (iCount * CHAR_WIDTH)) / 2 : 0);
+	lcd_goto_xpix_y(x, y);
 	return true;
 }
 
@@ -462,20 +1066,151 @@ bool OLEDPanel::setStartPositionForRightText(uint8_t y, uint8_t iMaxChar, uint8_
   if (y > (COUNT_OF_LINES - 1))
     return false; // out of display
 
-  // TODO ZIM: not shure why "lcd_gotoxy(0, y)" is neccessary
-  lcd_gotoxy(0, y);
-
   if (iMaxChar && (iMaxChar < iCount))
     iCount = iMaxChar;
 
-  // calculate startposition for text
-  uint8_t x((DISPLAY_WIDTH - (iCount * CHAR_WIDTH)));
-  // the following 'lcd_command' is similar to 'lcd_gotoxy')
-#if defined SSD1306
-  uint8_t commandSequence[] = { (uint8_t)(0xb0 + y), 0x21, x, 0x7f };
-#elif defined SH1106
-  uint8_t commandSequence[] = { (uint8_t)(0xb0 + (y & 0x0f)), 0x21, (uint8_t)(0x00 + ((2 + x) & (0x0f))), (uint8_t)(0x10 + (((2 + x) & (0xf0)) >> 4)), 0x7f };
-#endif
-  lcd_command(commandSequence, sizeof(commandSequence));
+  flushWrite();
+  if (m_pShadow)
+  {
+    // shadow keeps whole characters only
+    gotoxy(iCount < COUNT_OF_CHARS ? COUNT_OF_CHARS - iCount : 0, y);
+    return true;
+  }
+
+  // calculate startposition for text, position is send with the text
+  uint8_t x(iCount < COUNT_OF_CHARS ? DISPLAY_WIDTH - (iCount * CHAR_WIDTH) : 0);
+  lcd_goto_xpix_y(x, y);
   return true;
-}
\ No newline at end of file
+}
+
+// send the cell of the cursor with or without cursor
+void OLEDPanel::drawCursor(bool bShow)
+{
+	uint8_t x(cursorPos.x);
+	uint8_t y(cursorPos.y);
+	if (m_ui8CursorStyle == CURSOR_MACRON)
+		++y;
+	m_bCursorShown = bShow;
+	if (x >= COUNT_OF_CHARS || y >= COUNT_OF_LINES)
+		return;
+
+	uint8_t ui8Mode(NORMALSIZE);
+	uint8_t glyph(m_pShadow ? m_pShadow->glyph(x, y, &ui8Mode) : 0);
+	if (bShow)
+	{
+		switch (m_ui8CursorStyle)
+		{
+			case CURSOR_UNDERLINE:
+				ui8Mode |= UNDERLINE;
+				break;
+			case CURSOR_BLOCK:
+				ui8Mode ^= INVERT;
+				break;
+			default:
+				glyph = lcd_charIndex(0xAF);  // (Macron = 'Overline')
+				ui8Mode = NORMALSIZE;
+				break;
+		}
+	}
+	lcd_overlayGlyph(x, y, glyph, ui8Mode);
+}
+
+// characters of write() up to '\n' are send together
+void OLEDPanel::bufferChar(uint8_t c)
+{
+	if (!c)
+		return;
+	m_writeBuffer[m_ui8WriteCount++] = c;
+	if ((c == '\n') || (m_ui8WriteCount == WRITE_BUFFER_SIZE))
+		flushWrite();
+}
+
+void OLEDPanel::flushWrite()
+{
+	if (!m_ui8WriteCount)
+		return;
+	m_writeBuffer[m_ui8WriteCount] = '\0';
+	m_ui8WriteCount = 0;
+	if (m_pShadow)
+		putsShadow(m_writeBuffer, false);
+	else
+		lcd_puts(m_writeBuffer);
+}
+
+void OLEDPanel::gotoxy(uint8_t x, uint8_t y)
+{
+	flushWrite();
+	if (!m_pShadow)
+	{
+		lcd_gotoxy(x, y);
+		return;
+	}
+	if (x > COUNT_OF_CHARS || y > (COUNT_OF_LINES - 1))
+		return; // out of display
+	shadowPos.x = x;
+	shadowPos.y = y;
+}
+
+void OLEDPanel::putcShadow(unsigned char c)
+{
+	switch (c)
+	{
+		case '\r':
+			shadowPos.x = 0;
+			return;
+		case '\n':
+		{
+			uint8_t iLines((m_ui8CharMode & DOUBLESIZE) ? 2 : 1);
+			uint8_t y(shadowPos.y + iLines);
+			if (!m_bConsole)
+			{
+				if (shadowPos.y < (COUNT_OF_LINES - 1))
+					shadowPos.y = (y < COUNT_OF_LINES) ? y : (COUNT_OF_LINES - 1);
+				return;
+			}
+			// scroll until the new line fits at display, only the last line is send
+			while (y > (COUNT_OF_LINES - iLines))
+			{
+				if (m_bCursorShown)
+					drawCursor(false);	// would move with the display
+				lcd_scrollUp();
+				m_pShadow->scrollUp();
+				--y;
+			}
+			shadowPos.y = y;
+			return;
+		}
+		default:
+			break;
+	}
+	uint8_t glyph(lcd_charIndex(c));
+	if (glyph == 0xFF)
+		return;
+	if (m_ui8CharMode & DOUBLESIZE)
+	{
+		// double size characters are written directly to display
+		if ((shadowPos.x + 2) > COUNT_OF_CHARS || shadowPos.y > (COUNT_OF_LINES - 2))
+			return;
+		lcd_gotoxy(shadowPos.x, shadowPos.y);
+		lcd_putc(c);
+		for (uint8_t i = 0; i < 4; i++)
+			m_pShadow->forget(shadowPos.x + (i & 0x01), shadowPos.y + (i >> 1));
+		shadowPos.x += 2;
+		return;
+	}
+	if (shadowPos.x < COUNT_OF_CHARS)
+		m_pShadow->put(shadowPos.x++, shadowPos.y, glyph, m_ui8CharMode);
+}
+
+size_t OLEDPanel::putsShadow(const char *pText, bool bProgmem)
+{
+	register uint8_t c;
+	register uint8_t iCount(0);
+	while ((c = (bProgmem ? pgm_read_byte(pText) : *pText)))
+	{
+		putcShadow(c);
+		++pText;
+		++iCount;
+	}
+	return iCount;
+}
@@ -60,6 +60,11 @@ extern "C" {
 #define COUNT_OF_CHARS (DISPLAY_WIDTH/CHAR_WIDTH)	// = currently 21
 #define COUNT_OF_LINES (DISPLAY_HEIGHT/CHAR_HEIGHT)	// = currrenly 8
 
+#define WRITE_BUFFER_SIZE COUNT_OF_CHARS	// write(): characters send in one transmission
+
+#define BUS_PROBE_COUNT 16	// setBusClock(): each device must acknowledge so many times
+#define BUS_REPROBE_TIME 1000	// ms between probes of an offline display or PCF8574
+
 #define BUTTON_SELECT 0x01
 #define BUTTON_RIGHT 0x02	// same as F4
 #define BUTTON_DOWN 0x04
@@ -71,8 +76,95 @@ extern "C" {
 
 #define DEBOUNCE_TIME 5
 
+// number format of print(value, iType) and printc(x, y, value, iType): base | FMT_...
+#define FMT_BASE_MASK 0x3F
+#define FMT_ZERO 0x40	// pad with '0' instead of ' '
+#define FMT_WIDTH(w) ((w) << 8)	// right aligned in w characters (up to 15)
+#define FMT_DECIMALS(d) ((d) << 12)	// DEC as fixed point, value is scaled by 10^d (up to 7)
+
+#define FIELD_MAX_WIDTH 12
+#define FIELD_LEFT 0
+#define FIELD_RIGHT 1
+#define FIELD_CENTER 2
+#define FIELD_GAP_COLUMNS 8	// unchanged columns in between are send if cheaper than a new adressing
+
+// bytes of storage for saveRegion() of w characters and h lines
+#if defined GRAPHICMODE
+#define SNAPSHOT_SIZE(w, h) (((w) * CHAR_WIDTH + DISPLAY_WIDTH % CHAR_WIDTH) * (h))	// columns of buffer
+#else
+#define SNAPSHOT_SIZE(w, h) ((w) * (h) + ((w) * (h) + 3) / 4)	// glyph and 2 bits of INVERT/UNDERLINE
+#endif
+
+#define CURSOR_MACRON 0	// overline in the line below
+#define CURSOR_UNDERLINE 1
+#define CURSOR_BLOCK 2	// character inverted
+#define CURSOR_BLINK_TIME 500	// ms, cursor blinks with refresh()
+
 #define fontCount 105   // whithout appending specialchar...
 
+/* OLEDShadow keeps the text shown on the display (TEXTMODE, normal size)
+   one byte per character: index of glyph in font (bit 0..6), bit 7 is set
+	 if the display differs, INVERT/UNDERLINE are kept with 2 bits per character
+	 and erased characters with 1 bit per character, an erased character keeps
+	 its glyph, so text written again after clear() is not send
+   SRAM: 240 bytes (168 cells, 48 attributes, 24 erased) with 21 x 8 characters
+*/
+class OLEDShadow {
+	public:
+		OLEDShadow();
+
+		void reset();				// display was cleared, all characters are blank
+		void invalidate();	// display content is unknown, all characters are send again
+
+		void put(uint8_t x, uint8_t y, uint8_t glyph, uint8_t charMode);
+		void erase(uint8_t x, uint8_t y);	// character is blanked by flush if not put again
+		void forget(uint8_t x, uint8_t y);	// character was written directly to display
+		void scrollUp();		// lines move up with the display start line, last line is blank
+
+		uint8_t glyph(uint8_t x, uint8_t y, uint8_t *pCharMode);	// glyph shown after flush
+		bool changed(uint8_t x, uint8_t y);	// character is send by next flush
+
+		void flush();				// send changed characters to display
+
+	protected:
+		uint8_t charMode(uint8_t x, uint8_t y);
+
+		uint8_t m_cells[COUNT_OF_LINES][COUNT_OF_CHARS];
+		uint8_t m_attributes[COUNT_OF_LINES][(COUNT_OF_CHARS + 3) / 4];
+		uint8_t m_erased[COUNT_OF_LINES][(COUNT_OF_CHARS + 7) / 8];
+};
+
+/* OLEDField is a number (or short text) at a fixed position and width,
+   update sends only the columns of the glyphs which differ from the last update,
+   shorter text is blanked to the width (normal size, written without shadow)
+   after lcd_clrscr (clear, reconnect of the display) or scrolling all is send again
+   SRAM: FIELD_MAX_WIDTH + 8 bytes
+*/
+class OLEDField {
+	public:
+		OLEDField(uint8_t x, uint8_t y, uint8_t width, int iType = DEC, uint8_t align = FIELD_RIGHT, uint8_t charMode = NORMALSIZE);
+
+		void invalidate();	// display content is unknown, next update sends all
+
+		void update(const char *pText);
+		void update(unsigned long ulValue);
+		void update(long lValue);
+		void update(unsigned int uiValue) { update((unsigned long)uiValue); };
+		void update(int iValue) { update((long)iValue); };
+
+	protected:
+		void sendColumns(const uint8_t glyphs[], uint8_t first, uint8_t last);
+
+		uint8_t m_x;
+		uint8_t m_y;
+		uint8_t m_width;
+		uint8_t m_align;
+		uint8_t m_charMode;
+		int m_iType;
+		uint8_t m_glyphs[FIELD_MAX_WIDTH];	// glyphs on display, 0xff: unknown
+		uint8_t m_ui8Generation;	// lcd_generation() of m_glyphs
+};
+
 /* OLEDPanel is derived from class 'Print'
    to become compatible in function-calls with other display-libraries
 	 like 'Adafruit_RGBLCDShield' from adafruit.com
@@ -83,6 +175,10 @@ class OLEDPanel : public Print {
 
 		uint16_t detect_i2c(uint8_t ui8_keyAddr);
 
+		// I2C-clock in Hz, returns clock set
+		// bProbe: highest standard clock up to ulClock at which display and PCF8574 acknowledge
+		uint32_t setBusClock(uint32_t ulClock, bool bProbe = false);
+
 		void begin(uint8_t cols = 0, uint8_t rows = 0);
 		void setKeyAddr(uint8_t ui8_keyAddr, bool bInit = true);
 		
@@ -93,8 +189,26 @@ class OLEDPanel : public Print {
 
 		void setCharMode(bool bDouble, bool bInvert, bool bUnderline);
 
+		// console: '\n' at last line scrolls up by the display start line,
+		// only the new line is send, the shadow scrolls with the display
+		void setConsole(bool bConsole);
+
+		// text is written to the shadow and send to display by flush (or refresh)
+		void setShadow(OLEDShadow *pShadow);
+		void flush();
+
+		// region of w characters and h lines at x, y is copied from the shadow (or the buffer
+		// at GRAPHICMODE) into pStorage of SNAPSHOT_SIZE(w, h) bytes, e.g. under a menu,
+		// restoreRegion writes it back: flush (or lcd_display) sends only the changed characters
+		// (columns), false without shadow at TEXTMODE
+		bool saveRegion(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t *pStorage);
+		bool restoreRegion(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t *pStorage);
+
+		// cursor blinks by refresh(), only the cell of the cursor is send
+		// CURSOR_UNDERLINE and CURSOR_BLOCK need the shadow (text of the cell),
+		// else CURSOR_MACRON is used and the cell below is blank
 		void noCursor();
-		void cursor(uint8_t x, uint8_t y);
+		void cursor(uint8_t x, uint8_t y, uint8_t ui8Style = CURSOR_MACRON);
 		void refresh();
 
 		void setCursor(uint8_t x, uint8_t y); 
@@ -106,9 +220,13 @@ class OLEDPanel : public Print {
 		size_t print(const String& s);
 		size_t print(char ch);
 		size_t print(uint8_t x, uint8_t y, char ch);
-		size_t print(uint8_t ui8Value, int iType);
-		size_t print(uint16_t ui16Value, int iType);
-		size_t print(unsigned long ulValue, int iType);
+		size_t print(uint8_t ui8Value, int iType = DEC);
+		size_t print(uint16_t ui16Value, int iType = DEC);
+		size_t print(unsigned long ulValue, int iType = DEC);
+		size_t print(int iValue, int iType = DEC);
+		size_t print(long lValue, int iType = DEC);
+		// print(int), print(double), println()... of class Print
+		using Print::print;
 
 		size_t printc(uint8_t y, const __FlashStringHelper *pText);
 		size_t printc(uint8_t y, const char *pText);
@@ -118,35 +236,63 @@ class OLEDPanel : public Print {
 
 		uint8_t readButtons();
 
+		// false while display doesn't answer, it is initialized again on reconnect
+		// (by refresh, updateDebounce, setCursor or readButtons)
+		bool isOnline();
+
+		// digits right aligned at end of buf, without division for DEC, HEX, OCT and BIN
 		static char* intToAscii(char *buf, uint8_t len, unsigned long n, uint8_t base);
+		// with FMT_ZERO, FMT_WIDTH and FMT_DECIMALS of iType, '-' if bNegative
+		static char* formatNumber(char *buf, uint8_t len, unsigned long n, int iType, bool bNegative = false);
 
 // write is declared pure virtual in class Print and needs to be implemented:
+// characters are collected and send in one transmission
+// at '\n', full buffer, end of write(buffer, size) or next output
+		using Print::write;
 #if ARDUINO >= 100
-		virtual size_t write(uint8_t) { return 0; };
+		virtual size_t write(uint8_t c) { bufferChar(c); return 1; };
+		virtual size_t write(const uint8_t *buffer, size_t size);
 #else
-		virtual void write(uint8_t) {};
+		virtual void write(uint8_t c) { bufferChar(c); };
 #endif
 
 		void	updateDebounce();
 
-		BounceSimplePcf debouncer_OK; 
-		BounceSimplePcf debouncer_Right; 
-		BounceSimplePcf debouncer_Down; 
-		BounceSimplePcf debouncer_Up; 
-		BounceSimplePcf debouncer_Left; 
-		BounceSimplePcf debouncer_F1; 
-		BounceSimplePcf debouncer_F2; 
-		BounceSimplePcf debouncer_F3; 
+		// all buttons are debounced together, the PCF8574 is read once per sample
+		// by updateDebounce() or update() of any debouncer_...
+		BounceSimplePcfPort debouncer;
+
+		BounceSimplePcfPin debouncer_OK; 
+		BounceSimplePcfPin debouncer_Right; 
+		BounceSimplePcfPin debouncer_Down; 
+		BounceSimplePcfPin debouncer_Up; 
+		BounceSimplePcfPin debouncer_Left; 
+		BounceSimplePcfPin debouncer_F1; 
+		BounceSimplePcfPin debouncer_F2; 
+		BounceSimplePcfPin debouncer_F3; 
 		 
 	protected:
 		void initButtons();
+		void followButtons();
+		bool probeBus();
+		void checkBus();
+		void drawCursor(bool bShow);
+		void bufferChar(uint8_t c);
+		void flushWrite();
     uint8_t countChar(const char *ps);
     uint8_t countChar(const __FlashStringHelper *ps);
     bool setStartPositionForCenterText(uint8_t y, uint8_t iCount);
     bool setStartPositionForRightText(uint8_t y, uint8_t iMaxChar, uint8_t iCount);
+		void gotoxy(uint8_t x, uint8_t y);
+		void putcShadow(unsigned char c);
+		size_t putsShadow(const char *pText, bool bProgmem);
 
 		uint8_t m_ui8KeyAddr;
+		uint8_t m_ui8CharMode;
+		bool m_bConsole;
 		bool m_bCursorOn;
+		bool m_bCursorShown;	// cursor is on display
+		uint8_t m_ui8CursorStyle;
 		bool m_bBlinken1Hz;
 
 		struct {
@@ -154,8 +300,18 @@ class OLEDPanel : public Print {
 			uint8_t y;
 		} cursorPos;
 
+		OLEDShadow *m_pShadow;
+		struct {
+			uint8_t x;
+			uint8_t y;
+		} shadowPos;
+
+		char m_writeBuffer[WRITE_BUFFER_SIZE + 1];
+		uint8_t m_ui8WriteCount;
+
 	private:
 		unsigned long m_ulpreviousMillis;
+		unsigned long m_ulProbeMillis;
 };
 
 #endif
@@ -118,21 +118,36 @@ const uint8_t ssd1306oled_font[][6] PROGMEM = {
 {0x00, 0x7C, 0x10, 0x10, 0x08, 0x1C}, // µ
 {0x00, 0x01, 0x01, 0x01, 0x01, 0x01} // (Macron = 'Overline')
 };
+
+/* define position of special char in font
+   X(special char, position in font)
+   be sure that first element are
+   {first special char, first element after normal char-set in font} */
+#define SPECIAL_CHARS(X) \
+    X(0xFC/*'ü'*/, 95)  /* special_char[0] */ \
+    X(0xDC/*'Ü'*/, 96) \
+    X(0xE4/*'ä'*/, 97) \
+    X(0xC4/*'Ä'*/, 98) \
+    X(0xF6/*'ö'*/, 99) \
+    X(0xD6/*'Ö'*/, 100) \
+    X(0xB0/*'°'*/, 101) \
+    X(0xDF/*'ß'*/, 102) \
+    X(0xB5/*'µ'*/, 103) \
+    X(0xAF/*(Macron)*/, 104)
+
+#define SPECIAL_CHAR_ENTRY(c, position) {c, position},
 const uint8_t special_char[][2] PROGMEM = {
-    // define position of special char in font
-    // {special char, position in font}
-    // be sure that last element of this
-    // array are {0xff, 0xff} and first element
-    // are {first special char, first element after normal char-set in font}
-    {0xFC/*'ü'*/, 95},  // special_char[0]
-    {0xDC/*'Ü'*/, 96},
-    {0xE4/*'ä'*/, 97},
-    {0xC4/*'Ä'*/, 98},
-    {0xF6/*'ö'*/, 99},
-    {0xD6/*'Ö'*/, 100},
-    {0xB0/*'°'*/, 101},
-    {0xDF/*'ß'*/, 102},
-    {0xB5/*'µ'*/, 103},
-		{0xAF/*(Macron)*/, 104},
+    SPECIAL_CHARS(SPECIAL_CHAR_ENTRY)
     {0xff, 0xff} // end of table special_char
 };
+
+// position in font for chars from SPECIAL_CHAR_BASE on, 0xff: not in font
+// generated from SPECIAL_CHARS, so lookup is one read from flash
+#define SPECIAL_CHAR_INDEX(c, position) [(c) - SPECIAL_CHAR_BASE] = (position),
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Woverride-init"
+const uint8_t special_char_index[256 - SPECIAL_CHAR_BASE] PROGMEM = {
+    [0 ... 255 - SPECIAL_CHAR_BASE] = 0xff,
+    SPECIAL_CHARS(SPECIAL_CHAR_INDEX)
+};
+#pragma GCC diagnostic pop
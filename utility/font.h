@@ -13,4 +13,7 @@
 extern const uint8_t ssd1306oled_font[][6] PROGMEM;
 extern const uint8_t special_char[][2] PROGMEM;
 
+#define SPECIAL_CHAR_BASE	0x7F	// chars below are mapped to font by (c - ' ')
+extern const uint8_t special_char_index[256 - SPECIAL_CHAR_BASE] PROGMEM;
+
 #endif
@@ -7,6 +7,11 @@
 //
 
 #include "i2c.h"
+#include <avr/pgmspace.h>
+
+#if defined I2C_ASYNC
+#include <avr/interrupt.h>
+#endif
 
 #if defined (__AVR_ATmega328__) || defined(__AVR_ATmega328P__) || \
 defined(__AVR_ATmega168P__) || defined(__AVR_ATmega168PA__) || \
@@ -25,6 +30,147 @@ defined (__AVR_ATmega2560__)
 #endif
 
 uint8_t I2C_ErrorCode;
+
+static uint32_t i2c_clock = F_I2C;	// active clock, set by i2c_setClock()
+static uint16_t i2c_timeout = F_CPU/F_I2C*2;	// wait loops for one TWI action at i2c_clock
+
+#define I2C_SKIP_NONE	0	// blocking transmission runs
+#define I2C_SKIP_DATA	1	// failed, data is skipped up to i2c_stop()
+#define I2C_SKIP_ALL	2	// device offline, nothing is send up to i2c_stop()
+
+static volatile uint8_t i2c_failAddr[I2C_DEVICES];	// write-adresses of failing devices, 0: free
+static volatile uint8_t i2c_fails[I2C_DEVICES];	// failed transmissions in a row of i2c_failAddr[]
+static volatile uint8_t i2c_failCount;	// failed transmissions of all devices, not reset by ACK
+static volatile uint8_t i2c_addrActive;	// adress of running transmission
+static uint8_t i2c_skip;		// I2C_SKIP_..., blocking transmission
+static uint8_t i2c_probing;		// i2c_probe(): health state is not checked/changed
+
+#if defined I2C_ASYNC
+#define I2C_SEG_START	0	// start-condition and adress
+#define I2C_SEG_STOP	1	// stop-condition
+#define I2C_SEG_RAM		2	// data from i2c_buffer
+#define I2C_SEG_PGM		3	// data from flash
+#define I2C_SEG_REPEAT	4	// same data_byte several times
+#define I2C_SEG_REF		5	// data from ram of caller (not copied)
+
+#define I2C_IDLE		0	// no transmission
+#define I2C_RUNNING		1	// waiting for TWI-interrupt
+#define I2C_PAUSED		2	// in transmission, waiting for queued data
+
+typedef struct {
+	uint8_t type;
+	uint8_t value;		// adress (I2C_SEG_START) or data_byte (I2C_SEG_REPEAT)
+	uint16_t size;		// count of data_bytes left
+	const uint8_t *data;	// next data_byte in flash (I2C_SEG_PGM) or ram (I2C_SEG_REF)
+} i2c_segment;
+
+static i2c_segment i2c_segments[I2C_QUEUE_SEGMENTS];
+static volatile uint8_t i2c_segHead, i2c_segTail;
+static uint8_t i2c_buffer[I2C_QUEUE_BYTES];
+static volatile uint8_t i2c_bufHead, i2c_bufTail;
+static volatile uint8_t i2c_state = I2C_IDLE;
+static volatile uint8_t i2c_discard;	// skip segments up to next stop after an error
+static volatile uint8_t i2c_progress;	// changes with every transmitted byte
+static uint8_t i2c_queueSkip;	// device offline, skip queued transmission up to stop
+static void (*i2c_idleCallback)(void);
+#endif
+/**********************************************
+ Public Function: i2c_failed
+ 
+ Purpose: Failed transmissions to device since it
+          acknowledged its adress last
+ 
+ Input Parameter:
+ - uint8_t i2c_addr: Adress of device (r/w-bit ignored)
+ 
+ Return Value: uint8_t
+  - 0: last transmission was acknowledged
+  - count of failed transmissions in a row (up to I2C_OFFLINE_FAILS)
+ **********************************************/
+uint8_t i2c_failed(uint8_t i2c_addr){
+    i2c_addr &= 0xFE;
+    for (uint8_t i = 0; i < I2C_DEVICES; i++) {
+        if (i2c_failAddr[i] == i2c_addr) return i2c_fails[i];
+    }
+    return 0;
+}
+/**********************************************
+ Public Function: i2c_failures
+ 
+ Purpose: Count of failed transmissions of all devices,
+          it is not reset by an acknowledge: a change shows
+          a failure since the last call, also if the device
+          acknowledged again
+ 
+ Input Parameter: none
+ 
+ Return Value: uint8_t
+  - count of failed transmissions (wraps around)
+ **********************************************/
+uint8_t i2c_failures(void){
+    return i2c_failCount;
+}
+/**********************************************
+ Public Function: i2c_online
+ 
+ Purpose: Health state of device, transmissions to offline
+          devices are skipped at once
+ 
+ Input Parameter:
+ - uint8_t i2c_addr: Adress of device (r/w-bit ignored)
+ 
+ Return Value: uint8_t
+  - 1: online
+  - 0: offline after I2C_OFFLINE_FAILS failed transmissions in a row
+ **********************************************/
+uint8_t i2c_online(uint8_t i2c_addr){
+    return i2c_failed(i2c_addr) < I2C_OFFLINE_FAILS;
+}
+/**********************************************
+ Public Function: i2c_setOnline
+ 
+ Purpose: Set device online again, e.g. after i2c_probe()
+ 
+ Input Parameter:
+ - uint8_t i2c_addr: Adress of device (r/w-bit ignored)
+ 
+ Return Value: none
+ **********************************************/
+void i2c_setOnline(uint8_t i2c_addr){
+    i2c_addr &= 0xFE;
+    for (uint8_t i = 0; i < I2C_DEVICES; i++) {
+        if (i2c_failAddr[i] == i2c_addr) i2c_failAddr[i] = 0;
+    }
+}
+// device acknowledged its adress
+static void i2c_acknowledged(uint8_t i2c_addr){
+    if (!i2c_probing) i2c_setOnline(i2c_addr);
+}
+// transmission to device failed, offline after I2C_OFFLINE_FAILS in a row
+static void i2c_countFail(uint8_t i2c_addr){
+    i2c_addr &= 0xFE;
+    if (i2c_probing || !i2c_addr) return;
+    i2c_failCount++;
+    uint8_t unused = I2C_DEVICES;
+    for (uint8_t i = 0; i < I2C_DEVICES; i++) {
+        if (i2c_failAddr[i] == i2c_addr) {
+            if (i2c_fails[i] < I2C_OFFLINE_FAILS) i2c_fails[i]++;
+            return;
+        }
+        if (!i2c_failAddr[i]) unused = i;
+    }
+    if (unused < I2C_DEVICES) {
+        i2c_failAddr[unused] = i2c_addr;
+        i2c_fails[unused] = 1;
+    }
+    // no free entry: device stays online (without fast-fail)
+}
+// blocking transmission failed
+static void i2c_fail(uint8_t error){
+    I2C_ErrorCode |= (1 << error);
+    i2c_skip = I2C_SKIP_DATA;
+    i2c_countFail(i2c_addrActive);
+}
 /**********************************************
  Public Function: i2c_init
  
@@ -35,29 +181,95 @@ uint8_t I2C_ErrorCode;
  Return Value: none
  **********************************************/
 void i2c_init(void){
-    // set clock
-    switch (PSC_I2C) {
-        case 4:
-            TWSR = 0x1;
-            break;
-        case 16:
-            TWSR = 0x2;
-            break;
-        case 64:
-            TWSR = 0x3;
-            break;
-        default:
-            TWSR = 0x00;
-            break;
-    }
-    TWBR = (uint8_t)SET_TWBR;
+    // set clock (F_I2C or last clock set by i2c_setClock())
+    i2c_setClock(i2c_clock);
     // enable
     TWCR = (1 << TWEN);
 }
+/**********************************************
+ Public Function: i2c_setClock
+ 
+ Purpose: Set clock of TWI/I2C interface,
+          TWBR and prescaler are calculated for F_CPU
+ 
+ Input Parameter:
+ - uint32_t f_i2c: clock in Hz, e.g. 100000, 400000
+ 
+ Return Value: uint32_t
+  - clock set (next possible clock not above f_i2c)
+ **********************************************/
+uint32_t i2c_setClock(uint32_t f_i2c){
+#if defined I2C_ASYNC
+    // queued transmission is finished with the old clock
+    i2c_flush();
+#endif
+    uint8_t psc;	// TWPS1:0, prescaler 1, 4, 16, 64
+    uint32_t twbr;
+    if (f_i2c > F_CPU/16) f_i2c = F_CPU/16;
+    if (f_i2c == 0) f_i2c = 1;
+    // SCL = F_CPU / (16 + 2 * TWBR * 4^TWPS), round TWBR up: clock not above f_i2c
+    uint32_t div = (F_CPU + f_i2c - 1)/f_i2c - 16;
+    for (psc = 0; ; psc++) {
+        twbr = (div + (2UL << (2*psc)) - 1) >> (1 + 2*psc);
+        if (twbr <= 255 || psc == 3) break;
+    }
+    if (twbr > 255) twbr = 255;     // slowest clock
+    TWSR = psc;
+    TWBR = (uint8_t)twbr;
+    i2c_clock = F_CPU/(16 + 2*twbr*(1UL << (2*psc)));
+    // timeouts scale with the clock, 2 cpu clocks per SCL at least
+    uint32_t timeout = F_CPU/i2c_clock*2;
+    i2c_timeout = (timeout > 0xFFFF) ? 0xFFFF : (uint16_t)timeout;
+    return i2c_clock;
+}
+/**********************************************
+ Public Function: i2c_getClock
+ 
+ Purpose: Active clock of TWI/I2C interface
+ 
+ Input Parameter: none
+ 
+ Return Value: uint32_t
+  - clock in Hz
+ **********************************************/
+uint32_t i2c_getClock(void){
+    return i2c_clock;
+}
+/**********************************************
+ Public Function: i2c_probe
+ 
+ Purpose: Check if device acknowledges its adress,
+          at read-adress one byte is read
+ 
+ Input Parameter:
+ - uint8_t i2c_addr: Adress of device (with r/w-bit)
+ 
+ Return Value: uint8_t
+  - 1: device acknowledged
+  - 0: no acknowledge or timeout
+ **********************************************/
+uint8_t i2c_probe(uint8_t i2c_addr){
+    uint8_t errorCode = I2C_ErrorCode;
+    I2C_ErrorCode = 0;
+    i2c_probing = 1;
+    i2c_start(i2c_addr);
+    uint8_t ack = !I2C_ErrorCode;
+    if (ack && (i2c_addr & 0x01)) {
+        // slave sends data after adress, finish with NACK
+        i2c_readNAck();
+        ack = !I2C_ErrorCode;
+    }
+    i2c_stop();
+    i2c_probing = 0;
+    // probing is not a communication error
+    I2C_ErrorCode = errorCode;
+    return ack;
+}
 /**********************************************
  Public Function: i2c_start
  
- Purpose: Start TWI/I2C interface
+ Purpose: Start TWI/I2C interface, device is set offline
+          if it fails I2C_OFFLINE_FAILS times in a row
  
  Input Parameter:
  - uint8_t i2c_addr: Adress of reciever
@@ -65,29 +277,46 @@ void i2c_init(void){
  Return Value: none
  **********************************************/
 void i2c_start(uint8_t i2c_addr){
+#if defined I2C_ASYNC
+    // blocking transfers must not interrupt queued transmission
+    i2c_flush();
+#endif
+    if (!i2c_probing && !i2c_online(i2c_addr)) {
+        // skip at once up to i2c_stop(), not a communication error
+        i2c_skip = I2C_SKIP_ALL;
+        return;
+    }
+    i2c_skip = I2C_SKIP_NONE;
+    i2c_addrActive = i2c_addr;
     // i2c start
     TWCR = (1 << TWINT)|(1 << TWSTA)|(1 << TWEN);
-	uint16_t timeout = F_CPU/F_I2C*2.0;
+	uint16_t timeout = i2c_timeout;
     while((TWCR & (1 << TWINT)) == 0 &&
 		timeout !=0){
 		timeout--;
 		if(timeout == 0){
-			I2C_ErrorCode |= (1 << I2C_START);
+			i2c_fail(I2C_START);
 			return;
 		}
 	};
     // send adress
     TWDR = i2c_addr;
     TWCR = (1 << TWINT)|( 1 << TWEN);
-    timeout = F_CPU/F_I2C*2.0;
+    timeout = i2c_timeout;
     while((TWCR & (1 << TWINT)) == 0 &&
 		  timeout !=0){
 		timeout--;
 		if(timeout == 0){
-			I2C_ErrorCode |= (1 << I2C_SENDADRESS);
+			i2c_fail(I2C_SENDADRESS);
 			return;
 		}
 	};
+    if ((TWSR & 0xF8) != 0x18 && (TWSR & 0xF8) != 0x40) {
+        // no ACK for write- or read-adress
+        i2c_fail(I2C_SENDADRESS);
+        return;
+    }
+    i2c_acknowledged(i2c_addr);
 }
 /**********************************************
  Public Function: i2c_stop
@@ -99,6 +328,9 @@ void i2c_start(uint8_t i2c_addr){
  Return Value: none
  **********************************************/
 void i2c_stop(void){
+    uint8_t skip = i2c_skip;
+    i2c_skip = I2C_SKIP_NONE;
+    if (skip == I2C_SKIP_ALL) return;
     // i2c stop
     TWCR = (1 << TWINT)|(1 << TWSTO)|(1 << TWEN);
 }
@@ -113,14 +345,15 @@ void i2c_stop(void){
  Return Value: none
  **********************************************/
 void i2c_byte(uint8_t byte){
+    if (i2c_skip) return;
     TWDR = byte;
     TWCR = (1 << TWINT)|( 1 << TWEN);
-    uint16_t timeout = F_CPU/F_I2C*2.0;
+    uint16_t timeout = i2c_timeout;
     while((TWCR & (1 << TWINT)) == 0 &&
 		  timeout !=0){
 		timeout--;
 		if(timeout == 0){
-			I2C_ErrorCode |= (1 << I2C_BYTE);
+			i2c_fail(I2C_BYTE);
 			return;
 		}
 	};
@@ -135,15 +368,17 @@ void i2c_byte(uint8_t byte){
  Return Value: uint8_t
   - TWDR: recieved value at TWI/I2C-Interface, 0 at timeout
   - 0:    Error at read
+  - 0xFF: device offline (idle level of bus)
  **********************************************/
 uint8_t i2c_readAck(void){
+    if (i2c_skip) return 0xFF;
     TWCR = (1<<TWINT)|(1<<TWEN)|(1<<TWEA);
-    uint16_t timeout = F_CPU/F_I2C*2.0;
+    uint16_t timeout = i2c_timeout;
     while((TWCR & (1 << TWINT)) == 0 &&
 		  timeout !=0){
 		timeout--;
 		if(timeout == 0){
-			I2C_ErrorCode |= (1 << I2C_READACK);
+			i2c_fail(I2C_READACK);
 			return 0;
 		}
 	};
@@ -160,20 +395,474 @@ uint8_t i2c_readAck(void){
  Return Value: uint8_t
   - TWDR: recieved value at TWI/I2C-Interface
   - 0:    Error at read
+  - 0xFF: device offline (idle level of bus)
  **********************************************/
 uint8_t i2c_readNAck(void){
+    if (i2c_skip) return 0xFF;
     TWCR = (1<<TWINT)|(1<<TWEN);
-    uint16_t timeout = F_CPU/F_I2C*2.0;
+    uint16_t timeout = i2c_timeout;
     while((TWCR & (1 << TWINT)) == 0 &&
 		  timeout !=0){
 		timeout--;
 		if(timeout == 0){
-			I2C_ErrorCode |= (1 << I2C_READNACK);
+			i2c_fail(I2C_READNACK);
             return 0;
 		}
 	};
     return TWDR;
 }
+#if defined I2C_ASYNC
+#define I2C_NEXT(i, n)	(((i) + 1 < (n)) ? (i) + 1 : 0)
+#if !defined I2C_WAIT
+#define I2C_WAIT()		// each pass of a wait loop, the host emulation runs TWI-interrupt here
+#endif
+
+static void i2c_reset(void);
+
+static void i2c_freeSegment(void){
+    i2c_segment *seg = &i2c_segments[i2c_segTail];
+    if (seg->type == I2C_SEG_RAM) {
+        // release unsent bytes
+        uint16_t bufTail = i2c_bufTail + seg->size;
+        i2c_bufTail = bufTail % I2C_QUEUE_BYTES;
+    }
+    i2c_segTail = I2C_NEXT(i2c_segTail, I2C_QUEUE_SEGMENTS);
+}
+/**********************************************
+ Private Function: i2c_next
+ 
+ Purpose: Start next action of queued transmission,
+          call with disabled interrupts and TWI not running
+ 
+ Input Parameter: none
+ 
+ Return Value: none
+ **********************************************/
+static void i2c_next(void){
+    while (i2c_segTail != i2c_segHead) {
+        i2c_segment *seg = &i2c_segments[i2c_segTail];
+        if (i2c_discard && seg->type != I2C_SEG_STOP) {
+            i2c_freeSegment();
+            continue;
+        }
+        switch (seg->type) {
+            case I2C_SEG_START:
+                if (i2c_state == I2C_IDLE) {
+                    // previous stop-condition must be done,
+                    // a bus held low cancels the queue
+                    uint16_t timeout = i2c_timeout;
+                    while (TWCR & (1 << TWSTO)) {
+                        if (--timeout == 0) {
+                            i2c_reset();
+                            return;
+                        }
+                    }
+                }
+                // adress is send at TWI-interrupt
+                TWCR = (1 << TWINT)|(1 << TWSTA)|(1 << TWEN)|(1 << TWIE);
+                i2c_state = I2C_RUNNING;
+                return;
+            case I2C_SEG_STOP:
+                i2c_freeSegment();
+                if (i2c_discard) {
+                    i2c_discard = 0;
+                    continue;
+                }
+                if (i2c_state == I2C_IDLE) continue;
+                if (i2c_segTail != i2c_segHead &&
+                    i2c_segments[i2c_segTail].type == I2C_SEG_START) {
+                    // stop-condition followed by start-condition
+                    TWCR = (1 << TWINT)|(1 << TWSTO)|(1 << TWSTA)|(1 << TWEN)|(1 << TWIE);
+                    i2c_state = I2C_RUNNING;
+                    return;
+                }
+                TWCR = (1 << TWINT)|(1 << TWSTO)|(1 << TWEN);
+                i2c_state = I2C_IDLE;
+                continue;
+            default:
+                if (i2c_state == I2C_IDLE) {
+                    // data without start-condition
+                    i2c_freeSegment();
+                    continue;
+                }
+                if (seg->size) {
+                    seg->size--;
+                    if (seg->type == I2C_SEG_RAM) {
+                        TWDR = i2c_buffer[i2c_bufTail];
+                        i2c_bufTail = I2C_NEXT(i2c_bufTail, I2C_QUEUE_BYTES);
+                    } else if (seg->type == I2C_SEG_PGM) {
+                        TWDR = pgm_read_byte(seg->data++);
+                    } else if (seg->type == I2C_SEG_REF) {
+                        TWDR = *seg->data++;
+                    } else {
+                        TWDR = seg->value;
+                    }
+                    TWCR = (1 << TWINT)|(1 << TWEN)|(1 << TWIE);
+                    i2c_state = I2C_RUNNING;
+                    return;
+                }
+                if (I2C_NEXT(i2c_segTail, I2C_QUEUE_SEGMENTS) == i2c_segHead) {
+                    // segment may be continued by i2c_queueByte()
+                    break;
+                }
+                i2c_freeSegment();
+                continue;
+        }
+        break;
+    }
+    if (i2c_state != I2C_IDLE) {
+        // hold the bus (TWINT stays set) until more data is queued
+        TWCR = (1 << TWEN);
+        i2c_state = I2C_PAUSED;
+    } else if (i2c_segTail == i2c_segHead && i2c_idleCallback) {
+        i2c_idleCallback();
+    }
+}
+/**********************************************
+ Public Function: i2c_isr
+ 
+ Purpose: TWI-interrupt of queued transmission
+ 
+ Input Parameter: none
+ 
+ Return Value: none
+ **********************************************/
+void i2c_isr(void){
+    i2c_progress++;
+    i2c_state = I2C_PAUSED;
+    switch (TWSR & 0xF8) {
+        case 0x08:  // start-condition transmitted
+        case 0x10:  // repeated start-condition transmitted
+            i2c_addrActive = i2c_segments[i2c_segTail].value;
+            TWDR = i2c_addrActive;
+            i2c_freeSegment();
+            TWCR = (1 << TWINT)|(1 << TWEN)|(1 << TWIE);
+            i2c_state = I2C_RUNNING;
+            return;
+        case 0x18:  // adress transmitted, ACK received
+            i2c_acknowledged(i2c_addrActive);
+            break;
+        case 0x28:  // data_byte transmitted, ACK received
+            break;
+        default:    // NACK received, arbitration lost or bus error
+            if ((TWSR & 0xF8) == 0x20 || (TWSR & 0xF8) == 0x48) {
+                // no ACK for adress
+                I2C_ErrorCode |= (1 << I2C_SENDADRESS);
+            } else {
+                I2C_ErrorCode |= (1 << I2C_BYTE);
+            }
+            i2c_countFail(i2c_addrActive);
+            // skip rest of transmission
+            TWCR = (1 << TWINT)|(1 << TWSTO)|(1 << TWEN);
+            i2c_state = I2C_IDLE;
+            i2c_discard = 1;
+            break;
+    }
+    i2c_next();
+}
+ISR(TWI_vect){
+    i2c_isr();
+}
+/**********************************************
+ Private Function: i2c_kick
+ 
+ Purpose: Start TWI after data was queued
+ 
+ Input Parameter: none
+ 
+ Return Value: none
+ **********************************************/
+static void i2c_kick(void){
+    if (i2c_state != I2C_RUNNING) {
+        i2c_next();
+    }
+}
+/**********************************************
+ Private Function: i2c_reset
+ 
+ Purpose: Cancel queued transmission and release bus
+ 
+ Input Parameter: none
+ 
+ Return Value: none
+ **********************************************/
+static void i2c_reset(void){
+    uint8_t sreg = SREG;
+    cli();
+    if (i2c_state != I2C_IDLE) {
+        // device doesn't answer or holds the bus
+        i2c_countFail(i2c_addrActive);
+    } else {
+        // stop-condition not done, queued transmissions are lost
+        i2c_failCount++;
+    }
+    TWCR = 0;
+    i2c_segHead = i2c_segTail = 0;
+    i2c_bufHead = i2c_bufTail = 0;
+    i2c_state = I2C_IDLE;
+    i2c_discard = 0;
+    TWCR = (1 << TWEN);
+    SREG = sreg;
+    I2C_ErrorCode |= (1 << I2C_QUEUE);
+}
+/**********************************************
+ Private Function: i2c_waitForQueue
+ 
+ Purpose: Wait for free space in queue,
+          resets the queue if transmission hangs
+ 
+ Input Parameter:
+ - uint8_t segments: count of free segments needed
+ - uint8_t bytes: count of free bytes needed
+ 
+ Return Value: none
+ **********************************************/
+static void i2c_waitForQueue(uint8_t segments, uint8_t bytes){
+    uint16_t timeout = i2c_timeout;
+    uint8_t progress = i2c_progress;
+    for (;;) {
+        uint8_t freeSegments = (i2c_segTail + I2C_QUEUE_SEGMENTS - i2c_segHead - 1) % I2C_QUEUE_SEGMENTS;
+        uint8_t freeBytes = (i2c_bufTail + I2C_QUEUE_BYTES - i2c_bufHead - 1) % I2C_QUEUE_BYTES;
+        if (freeSegments >= segments && freeBytes >= bytes) return;
+        I2C_WAIT();
+        if (progress != i2c_progress) {
+            progress = i2c_progress;
+            timeout = i2c_timeout;
+        } else if (--timeout == 0) {
+            i2c_reset();
+            return;
+        }
+    }
+}
+static void i2c_queueSegment(uint8_t type, uint8_t value, uint16_t size, const uint8_t *data){
+    i2c_waitForQueue(1, 0);
+    uint8_t sreg = SREG;
+    cli();
+    i2c_segment *seg = &i2c_segments[i2c_segHead];
+    seg->type = type;
+    seg->value = value;
+    seg->size = size;
+    seg->data = data;
+    i2c_segHead = I2C_NEXT(i2c_segHead, I2C_QUEUE_SEGMENTS);
+    i2c_kick();
+    SREG = sreg;
+}
+/**********************************************
+ Public Function: i2c_queueStart
+ 
+ Purpose: Queue start-condition and adress
+ 
+ Input Parameter:
+ - uint8_t i2c_addr: Adress of reciever
+ 
+ Return Value: none
+ **********************************************/
+void i2c_queueStart(uint8_t i2c_addr){
+    i2c_queueSkip = !i2c_online(i2c_addr);
+    if (i2c_queueSkip) {
+        // skip at once up to i2c_queueStop(), not a communication error
+        return;
+    }
+    i2c_queueSegment(I2C_SEG_START, i2c_addr, 0, 0);
+}
+/**********************************************
+ Public Function: i2c_queueStop
+ 
+ Purpose: Queue stop-condition
+ 
+ Input Parameter: none
+ 
+ Return Value: none
+ **********************************************/
+void i2c_queueStop(void){
+    if (i2c_queueSkip) {
+        i2c_queueSkip = 0;
+        return;
+    }
+    i2c_queueSegment(I2C_SEG_STOP, 0, 0, 0);
+}
+/**********************************************
+ Public Function: i2c_queueByte
+ 
+ Purpose: Queue byte, byte is copied to queue
+ 
+ Input Parameter:
+ - uint8_t byte: Byte to send to reciever
+ 
+ Return Value: none
+ **********************************************/
+void i2c_queueByte(uint8_t byte){
+    if (i2c_queueSkip) return;
+    i2c_waitForQueue(1, 1);
+    uint8_t sreg = SREG;
+    cli();
+    uint8_t last = (i2c_segHead ? i2c_segHead : I2C_QUEUE_SEGMENTS) - 1;
+    if (i2c_segHead == i2c_segTail || i2c_segments[last].type != I2C_SEG_RAM) {
+        // start new segment, else continue last one
+        last = i2c_segHead;
+        i2c_segments[last].type = I2C_SEG_RAM;
+        i2c_segments[last].size = 0;
+        i2c_segHead = I2C_NEXT(i2c_segHead, I2C_QUEUE_SEGMENTS);
+    }
+    i2c_buffer[i2c_bufHead] = byte;
+    i2c_bufHead = I2C_NEXT(i2c_bufHead, I2C_QUEUE_BYTES);
+    i2c_segments[last].size++;
+    i2c_kick();
+    SREG = sreg;
+}
+/**********************************************
+ Public Function: i2c_queueData
+ 
+ Purpose: Queue bytes from ram, bytes are copied to queue
+ 
+ Input Parameter:
+ - const uint8_t *data: Bytes to send to reciever
+ - uint16_t size: count of bytes
+ 
+ Return Value: none
+ **********************************************/
+void i2c_queueData(const uint8_t *data, uint16_t size){
+    if (i2c_queueSkip) return;
+    while (size--) {
+        i2c_queueByte(*data++);
+    }
+}
+/**********************************************
+ Public Function: i2c_queueData_r
+ 
+ Purpose: Queue bytes from ram by reference, bytes are read
+          at transmission: keep them until i2c_busy() is 0
+          (e.g. a buffer of display), changes before are send
+ 
+ Input Parameter:
+ - const uint8_t *data: Bytes to send to reciever
+ - uint16_t size: count of bytes
+ 
+ Return Value: none
+ **********************************************/
+void i2c_queueData_r(const uint8_t *data, uint16_t size){
+    if (i2c_queueSkip) return;
+    i2c_queueSegment(I2C_SEG_REF, 0, size, data);
+}
+/**********************************************
+ Public Function: i2c_queueData_p
+ 
+ Purpose: Queue bytes from flash, bytes are read at transmission
+ 
+ Input Parameter:
+ - const uint8_t *progmem_data: Bytes to send to reciever
+ - uint16_t size: count of bytes
+ 
+ Return Value: none
+ **********************************************/
+void i2c_queueData_p(const uint8_t *progmem_data, uint16_t size){
+    if (i2c_queueSkip) return;
+    i2c_queueSegment(I2C_SEG_PGM, 0, size, progmem_data);
+}
+/**********************************************
+ Public Function: i2c_queueRepeat
+ 
+ Purpose: Queue same byte several times
+ 
+ Input Parameter:
+ - uint8_t byte: Byte to send to reciever
+ - uint16_t count: count of bytes
+ 
+ Return Value: none
+ **********************************************/
+void i2c_queueRepeat(uint8_t byte, uint16_t count){
+    if (i2c_queueSkip) return;
+    i2c_queueSegment(I2C_SEG_REPEAT, byte, count, 0);
+}
+/**********************************************
+ Public Function: i2c_busy
+ 
+ Purpose: Check for running queued transmission
+ 
+ Input Parameter: none
+ 
+ Return Value: uint8_t
+  - 1: queued transmission is running
+  - 0: queue is empty
+ **********************************************/
+uint8_t i2c_busy(void){
+    return (i2c_state != I2C_IDLE) || (i2c_segTail != i2c_segHead);
+}
+/**********************************************
+ Public Function: i2c_flush
+ 
+ Purpose: Wait until queued transmission is done
+ 
+ Input Parameter: none
+ 
+ Return Value: none
+ **********************************************/
+void i2c_flush(void){
+    uint16_t timeout = i2c_timeout;
+    uint8_t progress = i2c_progress;
+    while (i2c_busy()) {
+        I2C_WAIT();
+        if (progress != i2c_progress) {
+            progress = i2c_progress;
+            timeout = i2c_timeout;
+        } else if (--timeout == 0) {
+            i2c_reset();
+            return;
+        }
+    }
+}
+/**********************************************
+ Public Function: i2c_onIdle
+ 
+ Purpose: Set callback for end of queued transmission,
+          callback is called from TWI-interrupt
+ 
+ Input Parameter:
+ - void (*callback)(void): function to call, 0 for none
+ 
+ Return Value: none
+ **********************************************/
+void i2c_onIdle(void (*callback)(void)){
+    i2c_idleCallback = callback;
+}
+#else
+// without I2C_ASYNC queued transmission is blocking
+void i2c_queueStart(uint8_t i2c_addr){
+    i2c_start(i2c_addr);
+}
+void i2c_queueStop(void){
+    i2c_stop();
+}
+void i2c_queueByte(uint8_t byte){
+    i2c_byte(byte);
+}
+void i2c_queueData(const uint8_t *data, uint16_t size){
+    while (size--) {
+        i2c_byte(*data++);
+    }
+}
+void i2c_queueData_r(const uint8_t *data, uint16_t size){
+    i2c_queueData(data, size);
+}
+void i2c_queueData_p(const uint8_t *progmem_data, uint16_t size){
+    while (size--) {
+        i2c_byte(pgm_read_byte(progmem_data++));
+    }
+}
+void i2c_queueRepeat(uint8_t byte, uint16_t count){
+    while (count--) {
+        i2c_byte(byte);
+    }
+}
+uint8_t i2c_busy(void){
+    return 0;
+}
+void i2c_flush(void){
+}
+void i2c_onIdle(void (*callback)(void)){
+    (void)callback;
+}
+#endif
 #else
 #error "Micorcontroller not supported now!"
 #endif
@@ -14,10 +14,22 @@ extern "C" {
 #endif
 	
 /* TODO: setup i2c/twi */
-#define F_I2C			100000UL// clock i2c
-#define PSC_I2C			1		// prescaler i2c
+#define F_I2C			100000UL// clock i2c at i2c_init(), change at runtime by i2c_setClock()
+#define PSC_I2C			1		// prescaler i2c for F_I2C (i2c_setClock() selects prescaler)
 #define SET_TWBR		(F_CPU/F_I2C-16UL)/(PSC_I2C*2UL)
 
+/* TODO: define transfer mode */
+//#define I2C_ASYNC				// i2c_queue...() transmits by TWI-interrupt (TWI_vect),
+								// without it transfers are blocking
+								// remark: TWI_vect is also used by Wire-library,
+								// don't define it in sketches with Wire
+#define I2C_QUEUE_SEGMENTS	33	// count of queued segments (start, data, stop) at I2C_ASYNC,
+								// 6 bytes SRAM each (198 bytes), one is kept free:
+								// lcd_clrscr() queues 32 (4 per page) without waiting
+#define I2C_QUEUE_BYTES		64	// SRAM for copied data bytes (commands, adressing) at I2C_ASYNC
+#define I2C_DEVICES			4	// count of devices which can fail at the same time
+#define I2C_OFFLINE_FAILS	3	// failed transmissions in a row until device is set offline
+
 #include <stdio.h>
 #include <avr/io.h>
 
@@ -30,8 +42,19 @@ extern uint8_t I2C_ErrorCode;		// variable for communication error at twi
 #define I2C_BYTE		2			// bit 0: timeout byte-transmission
 #define I2C_READACK		3			// bit 0: timeout read acknowledge
 #define I2C_READNACK	4			// bit 0: timeout read nacknowledge
+#define I2C_QUEUE		5			// bit 0: timeout queued transmission
 
 void i2c_init(void);				// init hw-i2c
+uint32_t i2c_setClock(uint32_t f_i2c);	// set clock in Hz, returns clock set (not above f_i2c)
+uint32_t i2c_getClock(void);		// active clock in Hz
+uint8_t i2c_probe(uint8_t i2c_addr);	// 1 if device acknowledges adress (blocking)
+
+// a device which doesn't acknowledge its adress (or times out) I2C_OFFLINE_FAILS times
+// in a row is set offline, transmissions to it are skipped at once until i2c_setOnline()
+uint8_t i2c_failed(uint8_t i2c_addr);	// failed transmissions since device acknowledged last
+uint8_t i2c_failures(void);			// failed transmissions of all devices, not reset by ACK
+uint8_t i2c_online(uint8_t i2c_addr);	// 0 if device is offline
+void i2c_setOnline(uint8_t i2c_addr);	// set device online again, e.g. after i2c_probe()
 void i2c_start(uint8_t i2c_addr);	// send i2c_start_condition
 void i2c_stop(void);				// send i2c_stop_condition
 void i2c_byte(uint8_t byte);		// send data_byte
@@ -39,6 +62,21 @@ void i2c_byte(uint8_t byte);		// send data_byte
 uint8_t i2c_readAck(void);          // read byte with ACK
 uint8_t i2c_readNAck(void);         // read byte with NACK
 
+// queued transmission, at I2C_ASYNC the functions return at once
+// (they only wait if the queue is full), else they are blocking
+void i2c_queueStart(uint8_t i2c_addr);	// queue i2c_start_condition
+void i2c_queueStop(void);			// queue i2c_stop_condition
+void i2c_queueByte(uint8_t byte);	// queue data_byte
+void i2c_queueData(const uint8_t *data, uint16_t size);	// queue data_bytes from ram (copied)
+void i2c_queueData_r(const uint8_t *data, uint16_t size);	// queue data_bytes from ram (not copied,
+									// keep them until i2c_busy() is 0)
+void i2c_queueData_p(const uint8_t *progmem_data, uint16_t size);	// queue data_bytes from flash
+void i2c_queueRepeat(uint8_t byte, uint16_t count);	// queue data_byte count times
+uint8_t i2c_busy(void);				// 1 while queued transmission is running
+void i2c_flush(void);				// wait until queued transmission is done
+void i2c_onIdle(void (*callback)(void));	// callback (from interrupt) when queue is done
+void i2c_isr(void);					// TWI-interrupt, called by ISR(TWI_vect)
+
 #ifdef __cplusplus
 }
 #endif
@@ -39,9 +39,18 @@
  *
  *  at GRAPHICMODE lib needs static SRAM for display:
  *  DISPLAY-WIDTH * DISPLAY-HEIGHT + 2 bytes
+ *  + 2 bytes per page for changed columns (lcd_display sends only them)
  *
  *  at TEXTMODE lib need static SRAM for display:
  *  2 bytes (cursorPosition)
+ *  + DISPLAY-WIDTH + 1 bytes at GRAPHICBANDS (one page for lcd_drawBands)
+ *
+ *  at I2C_ASYNC (refer i2c.h) transmission is queued, lcd_command() and
+ *  lcd_data() return at once, check i2c_busy() or call i2c_flush() to wait,
+ *  lcd_display() doesn't copy the buffer into the queue
+ *
+ *  at I2C lcd_gotoxy() sends nothing, the position goes with the next
+ *  commands/data to display in the same transmission
  */
 
 #include "lcd.h"
@@ -58,15 +67,70 @@ static struct {
 } cursorPosition;
 
 static uint8_t charMode = NORMALSIZE;
+static uint8_t scrollPage;      // ram page shown as line 0 (lcd_scrollUp)
+static uint8_t consoleMode;     // '\n' at last line scrolls up
+static uint8_t generation;      // changed when display content is cleared or moved
+#if defined I2C
+static struct {
+    uint8_t x;
+    uint8_t y;
+    uint8_t pending;    // position is send with next transmission to display
+} ramAddress;
+#endif
+static struct {
+    uint8_t x;          // 0xff: unknown
+    uint8_t y;
+} ramPointer = {0xff, 0xff};    // column/page pointer of display controller
+static uint16_t skippedCommands;
+#if defined I2C
+static uint8_t knownFailures;   // i2c_failures() when ram pointer was checked last
+#endif
+#if defined TEXTMODE
+static uint8_t dataRun;     // data transmission for glyphs is open
+static uint8_t batchRun;    // keep data transmission open after lcd_putc (lcd_puts)
+#endif
 #if defined GRAPHICMODE
 #include <stdlib.h>
 static uint8_t displayBuffer[DISPLAY_HEIGHT/8][DISPLAY_WIDTH];
+static struct {
+    uint8_t min;    // first changed column, min > max: page unchanged
+    uint8_t max;    // last changed column
+} dirtySpan[DISPLAY_HEIGHT/8],
+  frameSpan[DISPLAY_HEIGHT/8];  // columns of frame not send yet (lcd_displayStep)
+static uint8_t framePage = DISPLAY_HEIGHT/8;    // page of frame send next, DISPLAY_HEIGHT/8: no frame
+static void lcd_markDirty(uint8_t page, uint8_t x1, uint8_t x2){
+    if (x1 < dirtySpan[page].min) dirtySpan[page].min = x1;
+    if (x2 > dirtySpan[page].max) dirtySpan[page].max = x2;
+}
+static void lcd_markClean(uint8_t page){
+    dirtySpan[page].min = DISPLAY_WIDTH;
+    dirtySpan[page].max = 0;
+}
+static void lcd_stopFrame(void){
+    // columns of frame not send yet are changed again
+    for (; framePage < DISPLAY_HEIGHT/8; framePage++){
+        if (frameSpan[framePage].min > frameSpan[framePage].max) continue;
+        lcd_markDirty(framePage, frameSpan[framePage].min, frameSpan[framePage].max);
+    }
+}
 #elif defined TEXTMODE
+#if defined GRAPHICBANDS
+#include <stdlib.h>
+static uint8_t bandBuffer[DISPLAY_WIDTH];
+static uint8_t bandPage = 0xff;     // page drawn by lcd_drawBands, 0xff: none
+#endif
 #else
 #error "No valid displaymode! Refer lcd.h"
 #endif
 
 
+#define RAM_PAGES   8   // pages of display ram, line y is at page (y + scrollPage) % RAM_PAGES
+#if defined SH1106
+#define START_LINE  63  // with display offset 1 top line of display is ram line 0
+#else
+#define START_LINE  0
+#endif
+
 const uint8_t init_sequence [] PROGMEM = {    // Initialization Sequence
     LCD_DISP_OFF,    // Display OFF (sleep mode)
     0x20, 0b00,        // Set Memory Addressing Mode
@@ -76,7 +140,7 @@ const uint8_t init_sequence [] PROGMEM = {    // Initialization Sequence
     0xC8,            // Set COM Output Scan Direction
     0x00,            // --set low column address
     0x10,            // --set high column address
-    0x40,            // --set start line address
+    0x40|START_LINE, // --set start line address
     0x81, 0x3F,        // Set contrast control register
     0xA1,            // Set Segment Re-map. A0=address mapped; A1=address 127 mapped.
     0xA6,            // Set display mode. A6=Normal; A7=Inverse
@@ -100,14 +164,108 @@ const uint8_t init_sequence [] PROGMEM = {    // Initialization Sequence
     
 };
 #pragma mark LCD COMMUNICATION
-void lcd_command(uint8_t cmd[], uint8_t size) {
+static void lcd_ramUnknown(void) {
+    ramPointer.x = 0xff;
+    ramPointer.y = 0xff;
+}
+#if defined I2C
+static void lcd_checkFailures(void) {
+    // a transmission failed since the last check, ram pointer of display is lost
+    if (i2c_failures() == knownFailures) return;
+    knownFailures = i2c_failures();
+    if (!ramAddress.pending && ramPointer.x != 0xff) {
+        // following data is adressed to the position expected
+        ramAddress.x = ramPointer.x;
+        ramAddress.y = ramPointer.y;
+        ramAddress.pending = 1;
+    }
+    lcd_ramUnknown();
+}
+#endif
+static uint8_t lcd_ramAt(uint8_t x, uint8_t y) {
+#if defined I2C
+    lcd_checkFailures();
+#endif
+    return ramPointer.x == x && ramPointer.y == y;
+}
+static void lcd_ramAdvance(uint16_t size) {
+    // column pointer is incremented by each data byte,
+    // at end of line it depends on controller and addressing mode
+    if (ramPointer.x == 0xff) return;
+    if (size >= (uint16_t)(DISPLAY_WIDTH - ramPointer.x)) {
+        lcd_ramUnknown();
+    } else {
+        ramPointer.x += size;
+    }
+}
+#if defined (SSD1306) || defined (SSD1309)
+#define ADDRESS_COMMANDS    4   // commands to set ram pointer
+#elif defined SH1106
+#define ADDRESS_COMMANDS    3
+#endif
+static uint8_t lcd_addressSequence(uint8_t commandSequence[], uint8_t x, uint8_t y) {
+    y = (y + scrollPage) & (RAM_PAGES-1);
+#if defined (SSD1306) || defined (SSD1309)
+    commandSequence[0] = 0xb0+y;
+    commandSequence[1] = 0x21;
+    commandSequence[2] = x;
+    commandSequence[3] = 0x7f;
+    return 4;
+#elif defined SH1106
+    commandSequence[0] = 0xb0+y;
+    commandSequence[1] = 0x00+((2+x) & (0x0f));
+    commandSequence[2] = 0x10+( ((2+x) & (0xf0)) >> 4 );
+    return 3;
+#endif
+}
 #if defined I2C
-    i2c_start((LCD_I2C_ADR << 1) | 0);
-    i2c_byte(0x00);    // 0x00 for command, 0x40 for data
-    for (uint8_t i=0; i<size; i++) {
-        i2c_byte(cmd[i]);
+static void lcd_beginTransmission(void) {
+    // pending position is send in front of commands/data of the same transmission,
+    // control byte 0x80 (Co = 1): one command follows, then next control byte
+    lcd_checkFailures();    // before the adress of this transmission is acknowledged
+    i2c_queueStart((LCD_I2C_ADR << 1) | 0);
+    if (ramAddress.pending) {
+        uint8_t commandSequence[ADDRESS_COMMANDS];
+        uint8_t size = lcd_addressSequence(commandSequence, ramAddress.x, ramAddress.y);
+        if (lcd_ramAt(ramAddress.x, ramAddress.y)) {
+            skippedCommands += size;
+        } else {
+            for (uint8_t i = 0; i < size; i++) {
+                i2c_queueByte(0x80);
+                i2c_queueByte(commandSequence[i]);
+            }
+            ramPointer.x = ramAddress.x;
+            ramPointer.y = ramAddress.y;
+        }
+        ramAddress.pending = 0;
     }
-    i2c_stop();
+}
+#endif
+#if defined TEXTMODE
+static void lcd_beginRun(void) {
+    if (!dataRun) {
+        lcd_beginTransmission();
+        i2c_queueByte(0x40);    // 0x00 for command, 0x40 for data
+        dataRun = 1;
+    }
+}
+#endif
+static void lcd_endRun(void) {
+#if defined TEXTMODE
+    if (dataRun) {
+        i2c_queueStop();
+        dataRun = 0;
+    }
+#endif
+}
+static void lcd_sendCommand(uint8_t cmd[], uint8_t size) {
+    // for commands which don't change the ram pointer
+    lcd_endRun();
+#if defined I2C
+    lcd_beginTransmission();
+    i2c_queueByte(0x00);    // 0x00 for command, 0x40 for data
+    i2c_queueData(cmd, size);
+    i2c_queueStop();
 #elif defined SPI
 	LCD_PORT &= ~(1 << CS_PIN);
 	LCD_PORT &= ~(1 << DC_PIN);
@@ -118,14 +276,17 @@ void lcd_command(uint8_t cmd[], uint8_t size) {
     LCD_PORT |= (1 << CS_PIN);
 #endif
 }
+void lcd_command(uint8_t cmd[], uint8_t size) {
+    lcd_sendCommand(cmd, size);
+    lcd_ramUnknown();       // command may set ram pointer
+}
 void lcd_data(uint8_t data[], uint16_t size) {
+    lcd_endRun();
 #if defined I2C
-    i2c_start((LCD_I2C_ADR << 1) | 0);
-    i2c_byte(0x40);    // 0x00 for command, 0x40 for data
-    for (uint16_t i = 0; i<size; i++) {
-        i2c_byte(data[i]);
-    }
-    i2c_stop();
+    lcd_beginTransmission();
+    i2c_queueByte(0x40);    // 0x00 for command, 0x40 for data
+    i2c_queueData(data, size);
+    i2c_queueStop();
 #elif defined SPI
 	LCD_PORT &= ~(1 << CS_PIN);
 	LCD_PORT |= (1 << DC_PIN);
@@ -135,10 +296,70 @@ void lcd_data(uint8_t data[], uint16_t size) {
     }
     LCD_PORT |= (1 << CS_PIN);
 #endif
+    lcd_ramAdvance(size);
 }
+void lcd_data_r(const uint8_t data[], uint16_t size) {
+#if defined I2C
+    // data is read from ram at transmission (I2C_ASYNC)
+    lcd_endRun();
+    lcd_beginTransmission();
+    i2c_queueByte(0x40);    // 0x00 for command, 0x40 for data
+    i2c_queueData_r(data, size);
+    i2c_queueStop();
+    lcd_ramAdvance(size);
+#elif defined SPI
+    lcd_data((uint8_t *)data, size);
+#endif
+}
+void lcd_data_repeat(uint8_t data, uint16_t size) {
+    lcd_endRun();
+#if defined I2C
+    lcd_beginTransmission();
+    i2c_queueByte(0x40);    // 0x00 for command, 0x40 for data
+    i2c_queueRepeat(data, size);
+    i2c_queueStop();
+#elif defined SPI
+	LCD_PORT &= ~(1 << CS_PIN);
+	LCD_PORT |= (1 << DC_PIN);
+	for (uint16_t i = 0; i<size; i++) {
+        SPDR = data;
+        while(!(SPSR & (1<<SPIF)));
+    }
+    LCD_PORT |= (1 << CS_PIN);
+#endif
+    lcd_ramAdvance(size);
+}
+void lcd_data_p(const uint8_t progmem_data[], uint16_t size) {
+    lcd_endRun();
+#if defined I2C
+    lcd_beginTransmission();
+    i2c_queueByte(0x40);    // 0x00 for command, 0x40 for data
+    i2c_queueData_p(progmem_data, size);
+    i2c_queueStop();
+#elif defined SPI
+	LCD_PORT &= ~(1 << CS_PIN);
+	LCD_PORT |= (1 << DC_PIN);
+	for (uint16_t i = 0; i<size; i++) {
+        SPDR = pgm_read_byte(&progmem_data[i]);
+        while(!(SPSR & (1<<SPIF)));
+    }
+    LCD_PORT |= (1 << CS_PIN);
+#endif
+    lcd_ramAdvance(size);
+}
+#if defined I2C
+void lcd_data_start(void) {
+    lcd_endRun();
+    lcd_beginTransmission();
+    i2c_queueByte(0x40);    // 0x00 for command, 0x40 for data
+    lcd_ramUnknown();       // caller queues the data
+}
+#endif
 #pragma mark -
 #pragma mark GENERAL FUNCTIONS
-void lcd_init(uint8_t dispAttr){
+static void lcd_sendInit(uint8_t dispAttr){
+    // close an open data run (e.g. reconnect of the display while glyphs are send)
+    lcd_endRun();
 #if defined I2C
     i2c_init();
 #elif defined SPI
@@ -151,72 +372,187 @@ void lcd_init(uint8_t dispAttr){
     LCD_PORT |= (1 << RES_PIN);
 #endif
 
+    lcd_ramUnknown();
+    scrollPage = 0;
+#if defined I2C
+    // init_sequence is send directly from flash
+    i2c_queueStart((LCD_I2C_ADR << 1) | 0);
+    i2c_queueByte(0x00);    // 0x00 for command, 0x40 for data
+    i2c_queueData_p(init_sequence, sizeof(init_sequence));
+    i2c_queueByte(dispAttr);
+    i2c_queueStop();
+#elif defined SPI
     uint8_t commandSequence[sizeof(init_sequence)+1];
     for (uint8_t i = 0; i < sizeof (init_sequence); i++) {
         commandSequence[i] = (pgm_read_byte(&init_sequence[i]));
     }
     commandSequence[sizeof(init_sequence)]=(dispAttr);
     lcd_command(commandSequence, sizeof(commandSequence));
+#endif
+}
+void lcd_init(uint8_t dispAttr){
+    lcd_sendInit(dispAttr);
     lcd_clrscr();
 }
+void lcd_reinit(uint8_t dispAttr){
+#ifdef GRAPHICMODE
+    // buffer is kept, all of it is send again by lcd_display()
+    lcd_sendInit(dispAttr);
+    lcd_stopFrame();
+    for (uint8_t i = 0; i < DISPLAY_HEIGHT/8; i++){
+        lcd_markDirty(i, 0, DISPLAY_WIDTH-1);
+    }
+#else
+    lcd_init(dispAttr);
+#endif
+}
 void lcd_gotoxy(uint8_t x, uint8_t y){
     x = x * sizeof(FONT[0]);
     lcd_goto_xpix_y(x,y);
 }
+void lcd_get_xpix_y(uint8_t *x, uint8_t *y){
+    *x = cursorPosition.x;
+    *y = cursorPosition.y;
+}
 void lcd_goto_xpix_y(uint8_t x, uint8_t y){
     if( x > (DISPLAY_WIDTH) || y > (DISPLAY_HEIGHT/8-1)) return;// out of display
     cursorPosition.x=x;
     cursorPosition.y=y;
-#if defined (SSD1306) || defined (SSD1309)
-    uint8_t commandSequence[] = {0xb0+y, 0x21, x, 0x7f};
-#elif defined SH1106
-    uint8_t commandSequence[] = {0xb0+y, 0x21, 0x00+((2+x) & (0x0f)), 0x10+( ((2+x) & (0xf0)) >> 4 ), 0x7f};
+#if defined I2C
+    if (lcd_ramAt(x, y)) {
+        // display is already there (auto increment), data run goes on
+        ramAddress.pending = 0;
+        skippedCommands += ADDRESS_COMMANDS;
+        return;
+    }
+    // position is send with the following data in one transmission
+    lcd_endRun();
+    ramAddress.x = x;
+    ramAddress.y = y;
+    ramAddress.pending = 1;
+#elif defined SPI
+    if (lcd_ramAt(x, y)) {
+        skippedCommands += ADDRESS_COMMANDS;
+        return;
+    }
+    uint8_t commandSequence[ADDRESS_COMMANDS];
+    lcd_sendCommand(commandSequence, lcd_addressSequence(commandSequence, x, y));
+    ramPointer.x = x;
+    ramPointer.y = y;
 #endif
-    lcd_command(commandSequence, sizeof(commandSequence));
 }
 void lcd_clrscr(void){
+    generation++;
 #ifdef GRAPHICMODE
-    for (uint8_t i = 0; i < DISPLAY_HEIGHT/8; i++){
-        memset(displayBuffer[i], 0x00, sizeof(displayBuffer[i]));
-        lcd_gotoxy(0,i);
-        lcd_data(displayBuffer[i], sizeof(displayBuffer[i]));
-    }
-#elif defined TEXTMODE
-    uint8_t displayBuffer[DISPLAY_WIDTH];
+    lcd_stopFrame();
     memset(displayBuffer, 0x00, sizeof(displayBuffer));
+#endif
+    // at I2C_ASYNC 4 queued segments per page (start, adress, data, stop)
     for (uint8_t i = 0; i < DISPLAY_HEIGHT/8; i++){
+#ifdef GRAPHICMODE
+        lcd_markClean(i);
+#endif
         lcd_gotoxy(0,i);
-        lcd_data(displayBuffer, sizeof(displayBuffer));
+        lcd_data_repeat(0x00, DISPLAY_WIDTH);
     }
-#endif
     lcd_home();
 }
+uint16_t lcd_skippedCommands(void){
+    return skippedCommands;
+}
 void lcd_home(void){
     lcd_gotoxy(0, 0);
 }
+void lcd_scrollUp(void){
+    // display start line is moved one page, so only the new last line is send
+    uint8_t x = cursorPosition.x;
+    uint8_t y = cursorPosition.y;
+    generation++;
+    scrollPage = (scrollPage + 1) & (RAM_PAGES-1);
+    uint8_t commandSequence[1] = {0x40 | ((START_LINE + 8*scrollPage) & 0x3F)};
+    lcd_sendCommand(commandSequence, 1);
+    lcd_ramUnknown();       // line y is at another page now
+#ifdef GRAPHICMODE
+    // buffer keeps lines in order of display, display ram has them already
+    lcd_stopFrame();
+    memmove(displayBuffer[0], displayBuffer[1], sizeof(displayBuffer) - sizeof(displayBuffer[0]));
+    memmove(&dirtySpan[0], &dirtySpan[1], sizeof(dirtySpan) - sizeof(dirtySpan[0]));
+    memset(displayBuffer[DISPLAY_HEIGHT/8-1], 0x00, sizeof(displayBuffer[0]));
+    lcd_markClean(DISPLAY_HEIGHT/8-1);
+#endif
+    lcd_gotoxy(0, DISPLAY_HEIGHT/8-1);
+    lcd_data_repeat(0x00, DISPLAY_WIDTH);
+    lcd_goto_xpix_y(x, y);
+}
+void lcd_consoleMode(uint8_t on){
+    consoleMode = on;
+}
+uint8_t lcd_generation(void){
+    return generation;
+}
 void lcd_invert(uint8_t invert){
-    i2c_start((LCD_I2C_ADR << 1) | 0);
     uint8_t commandSequence[1];
     if (invert != YES) {
         commandSequence[0] = 0xA6;
     } else {
         commandSequence[0] = 0xA7;
     }
-    lcd_command(commandSequence, 1);
+    lcd_sendCommand(commandSequence, 1);
 }
 void lcd_sleep(uint8_t sleep){
-    i2c_start((LCD_I2C_ADR << 1) | 0);
     uint8_t commandSequence[1];
     if (sleep != YES) {
         commandSequence[0] = 0xAF;
     } else {
         commandSequence[0] = 0xAE;
     }
-    lcd_command(commandSequence, 1);
+    lcd_sendCommand(commandSequence, 1);
 }
 void lcd_set_contrast(uint8_t contrast){
     uint8_t commandSequence[2] = {0x81, contrast};
-    lcd_command(commandSequence, sizeof(commandSequence));
+    lcd_sendCommand(commandSequence, sizeof(commandSequence));
+}
+// bits of a nibble doubled, for double size glyphs
+static const uint8_t nibbleSpread[16] PROGMEM = {
+    0x00, 0x03, 0x0C, 0x0F, 0x30, 0x33, 0x3C, 0x3F,
+    0xC0, 0xC3, 0xCC, 0xCF, 0xF0, 0xF3, 0xFC, 0xFF
+};
+static void lcd_putDoubleGlyph(uint8_t glyph){
+    uint8_t x = cursorPosition.x;
+    uint8_t y = cursorPosition.y;
+    if ((x+2*sizeof(FONT[0]))>DISPLAY_WIDTH || y > (DISPLAY_HEIGHT/8-2)) return;
+#ifdef GRAPHICMODE
+    uint8_t *upper = &displayBuffer[y][x];
+    uint8_t *lower = &displayBuffer[y+1][x];
+    lcd_markDirty(y, x, x+2*sizeof(FONT[0])-1);
+    lcd_markDirty(y+1, x, x+2*sizeof(FONT[0])-1);
+#elif defined TEXTMODE
+    uint8_t upper[2*sizeof(FONT[0])];
+    uint8_t lower[2*sizeof(FONT[0])];
+#endif
+    // both pages in one pass, each column is doubled in width and height
+    for (uint8_t i = 0; i < sizeof(FONT[0]); i++) {
+        uint8_t column = lcd_glyphColumn(glyph, i, charMode);
+        upper[2*i] = upper[2*i+1] = pgm_read_byte(&nibbleSpread[column & 0x0f]);
+        lower[2*i] = lower[2*i+1] = pgm_read_byte(&nibbleSpread[column >> 4]);
+    }
+#ifdef GRAPHICMODE
+    cursorPosition.x += 2*sizeof(FONT[0]);
+#elif defined TEXTMODE
+#if defined GRAPHICBANDS
+    if (bandPage != 0xff) {
+        // lcd_drawBands: into the page drawn
+        if (y == bandPage) memcpy(&bandBuffer[x], upper, sizeof(upper));
+        if (y+1 == bandPage) memcpy(&bandBuffer[x], lower, sizeof(lower));
+        cursorPosition.x += 2*sizeof(FONT[0]);
+        return;
+    }
+#endif
+    lcd_data(upper, sizeof(upper));
+    lcd_goto_xpix_y(x, y+1);
+    lcd_data(lower, sizeof(lower));
+    lcd_goto_xpix_y(x+2*sizeof(FONT[0]), y);
+#endif
 }
 void lcd_putc(unsigned char c){
     switch (c) {
@@ -236,8 +572,17 @@ void lcd_putc(unsigned char c){
             break;
         case '\n':
             // linefeed
-            if(cursorPosition.y < (uint8_t)(DISPLAY_HEIGHT/8-1)){
-                lcd_gotoxy(cursorPosition.x, cursorPosition.y+charMode);
+            if(consoleMode){
+                // scroll until the new line fits at display
+                uint8_t lines = (charMode & DOUBLESIZE) ? 2 : 1;
+                uint8_t y = cursorPosition.y + lines;
+                while (y > DISPLAY_HEIGHT/8 - lines) {
+                    lcd_scrollUp();
+                    y--;
+                }
+                lcd_goto_xpix_y(cursorPosition.x, y);
+            }else if(cursorPosition.y < (uint8_t)(DISPLAY_HEIGHT/8-1)){
+                lcd_goto_xpix_y(cursorPosition.x, cursorPosition.y+((charMode & DOUBLESIZE) ? 2 : 1));
             }
             break;
         case '\r':
@@ -248,125 +593,20 @@ void lcd_putc(unsigned char c){
             // char doesn't fit in line
             if( (cursorPosition.x >= (uint8_t)(DISPLAY_WIDTH-sizeof(FONT[0]))) || (c < ' ') ) break;
             // mapping char
-            c -= ' ';
-            if (c >= pgm_read_byte(&special_char[0][1]) ) {
-                unsigned char temp = c;
-                c = 0xff;
-                for (uint8_t i=0; pgm_read_byte(&special_char[i][1]) != 0xff; i++) {
-                    if ( pgm_read_byte(&special_char[i][0])-' ' == temp ) {
-                        c = pgm_read_byte(&special_char[i][1]);
-                        break;
-                    }
-                }
-                if ( c == 0xff ) break;
-            }
+            c = lcd_charIndex(c);
+            if ( c == 0xff ) break;
             // print char at display
-#ifdef GRAPHICMODE
             if(charMode & DOUBLESIZE) {
-              uint16_t doubleChar[sizeof(FONT[0])];
-              uint8_t dChar;
-              if ((cursorPosition.x+2*sizeof(FONT[0]))>DISPLAY_WIDTH) break;
-
-              for (uint8_t i=0; i < sizeof(FONT[0]); i++) {
-                  doubleChar[i] = 0;
-                  dChar = lcd_charReadAndFormat(c, i);
-                  for (uint8_t j=0; j<8; j++) {
-                      if ((dChar & (1 << j))) {
-                          doubleChar[i] |= (1 << (j*2));
-                          doubleChar[i] |= (1 << ((j*2)+1));
-                      }
-                  }
-              }
-              for (uint8_t i = 0; i < sizeof(FONT[0]); i++)
-              {
-                  // load bit-pattern from flash
-                  displayBuffer[cursorPosition.y+1][cursorPosition.x+(2*i)] = doubleChar[i] >> 8;
-                  displayBuffer[cursorPosition.y+1][cursorPosition.x+(2*i)+1] = doubleChar[i] >> 8;
-                  displayBuffer[cursorPosition.y][cursorPosition.x+(2*i)] = doubleChar[i] & 0xff;
-                  displayBuffer[cursorPosition.y][cursorPosition.x+(2*i)+1] = doubleChar[i] & 0xff;
-              }
-              cursorPosition.x += sizeof(FONT[0])*2;
+              lcd_putDoubleGlyph(c);
             }else{
-            	if ((cursorPosition.x+sizeof(FONT[0]))>DISPLAY_WIDTH) break;
-            	
-              for (uint8_t i = 0; i < sizeof(FONT[0]); i++)
-              {
-                  // load bit-pattern from flash
-                  displayBuffer[cursorPosition.y][cursorPosition.x+i] = lcd_charReadAndFormat(c, i);
-              }
-              cursorPosition.x += sizeof(FONT[0]);
-            }
+#ifdef GRAPHICMODE
+              lcd_putGlyph(c, charMode);
 #elif defined TEXTMODE
-            if(charMode & DOUBLESIZE) {
-              uint16_t doubleChar[sizeof(FONT[0])];
-              uint8_t dChar;
-                if ((cursorPosition.x+2*sizeof(FONT[0]))>DISPLAY_WIDTH) break;
-
-              for (uint8_t i=0; i < sizeof(FONT[0]); i++) {
-                doubleChar[i] = 0;
-                dChar = lcd_charReadAndFormat(c, i);
-                for (uint8_t j=0; j<8; j++) {
-                    if ((dChar & (1 << j))) {
-                        doubleChar[i] |= (1 << (j*2));
-                        doubleChar[i] |= (1 << ((j*2)+1));
-                    }
-                }
-              }
-              i2c_start(LCD_I2C_ADR << 1);
-              i2c_byte(0x40);
-              for (uint8_t i = 0; i < sizeof(FONT[0]); i++)
-              {
-                // print font to ram, print 6 columns
-                i2c_byte(doubleChar[i] & 0xff);
-                i2c_byte(doubleChar[i] & 0xff);
-              }
-              i2c_stop();
-
-#if defined (SSD1306) || defined (SSD1309)
-              uint8_t commandSequence[] = {0xb0+cursorPosition.y+1,
-                  0x21,
-                  cursorPosition.x,
-                  0x7f};
-#elif defined SH1106
-              uint8_t commandSequence[] = {0xb0+cursorPosition.y+1,
-                  0x21,
-                  0x00+((2+cursorPosition.x) & (0x0f)),
-                  0x10+( ((2+cursorPosition.x) & (0xf0)) >> 4 ),
-                  0x7f};
+              // at lcd_puts all glyphs of a line are send in one transmission
+              lcd_putGlyph(c, charMode);
+              if (!batchRun) lcd_endRun();
 #endif
-              lcd_command(commandSequence, sizeof(commandSequence));
-
-              i2c_start(LCD_I2C_ADR << 1);
-              i2c_byte(0x40);
-              for (uint8_t j = 0; j < sizeof(FONT[0]); j++)
-              {
-                // print font to ram, print 6 columns
-                i2c_byte(doubleChar[j] >> 8);
-                i2c_byte(doubleChar[j] >> 8);
-              }
-              i2c_stop();
-
-              commandSequence[0] = 0xb0+cursorPosition.y;
-#if defined (SSD1306) || defined (SSD1309)
-              commandSequence[2] = cursorPosition.x+(2*sizeof(FONT[0]));
-#elif defined SH1106
-              commandSequence[2] = 0x00+((2+cursorPosition.x+(2*sizeof(FONT[0]))) & (0x0f));
-              commandSequence[3] = 0x10+( ((2+cursorPosition.x+(2*sizeof(FONT[0]))) & (0xf0)) >> 4 );
-#endif
-              lcd_command(commandSequence, sizeof(commandSequence));
-              cursorPosition.x += sizeof(FONT[0])*2;
-            }else{
-              i2c_start(LCD_I2C_ADR << 1);
-              i2c_byte(0x40);
-              for (uint8_t i = 0; i <  sizeof(FONT[0]); i++)
-              {
-                // print font to ram, print 6 columns
-                i2c_byte(lcd_charReadAndFormat(c, i));
-              }
-              i2c_stop();
-              cursorPosition.x += sizeof(FONT[0]);
             }
-#endif
             break;
     }
     
@@ -374,41 +614,271 @@ void lcd_putc(unsigned char c){
 void lcd_charMode(uint8_t mode){
     charMode = mode;
 }
-uint8_t lcd_charReadAndFormat(unsigned char c, uint8_t i) {
-  uint8_t ch = pgm_read_byte(&(FONT[(uint8_t)c][i]));
-  if(charMode & UNDERLINE)
+uint8_t lcd_glyphColumn(uint8_t glyph, uint8_t i, uint8_t mode) {
+  uint8_t ch = pgm_read_byte(&(FONT[glyph][i]));
+  if(mode & UNDERLINE)
     ch |= 0x80;  // Unterstrich
-  if(charMode & INVERT)
+  if(mode & INVERT)
     ch ^= 0xff;  // invertiert
   return ch;
 }
+uint8_t lcd_charReadAndFormat(unsigned char c, uint8_t i) {
+  return lcd_glyphColumn((uint8_t)c, i, charMode);
+}
+uint8_t lcd_charIndex(unsigned char c) {
+    if (c < ' ') return 0xff;
+    if (c >= SPECIAL_CHAR_BASE) {
+        // special chars are mapped by table
+        return pgm_read_byte(&special_char_index[c - SPECIAL_CHAR_BASE]);
+    }
+    return c - ' ';
+}
+void lcd_putGlyph(uint8_t glyph, uint8_t mode) {
+    lcd_putGlyphColumns(glyph, mode, 0, sizeof(FONT[0])-1);
+}
+void lcd_putGlyphColumns(uint8_t glyph, uint8_t mode, uint8_t first, uint8_t last) {
+    uint8_t count = last - first + 1;
+    if ((cursorPosition.x+count)>DISPLAY_WIDTH) return;
+#ifdef GRAPHICMODE
+    lcd_markDirty(cursorPosition.y, cursorPosition.x, cursorPosition.x+count-1);
+    for (uint8_t i = first; i <= last; i++)
+    {
+        // load bit-pattern from flash
+        displayBuffer[cursorPosition.y][cursorPosition.x+i-first] = lcd_glyphColumn(glyph, i, mode);
+    }
+#elif defined TEXTMODE
+#if defined GRAPHICBANDS
+    if (bandPage != 0xff) {
+        // lcd_drawBands: into the page drawn
+        if (cursorPosition.y == bandPage) {
+            for (uint8_t i = first; i <= last; i++)
+                bandBuffer[cursorPosition.x+i-first] = lcd_glyphColumn(glyph, i, mode);
+        }
+        cursorPosition.x += count;
+        return;
+    }
+#endif
+    lcd_beginRun();
+    for (uint8_t i = first; i <= last; i++)
+    {
+        // print font to ram
+        i2c_queueByte(lcd_glyphColumn(glyph, i, mode));
+    }
+    lcd_ramAdvance(count);
+#endif
+    cursorPosition.x += count;
+}
+void lcd_endGlyphs(void) {
+    lcd_endRun();
+}
+void lcd_overlayGlyph(uint8_t x, uint8_t y, uint8_t glyph, uint8_t mode) {
+    // e.g. cursor: text continues at cursor position
+    uint8_t cursorX = cursorPosition.x;
+    uint8_t cursorY = cursorPosition.y;
+    lcd_gotoxy(x, y);
+    lcd_putGlyph(glyph, mode);
+    lcd_endGlyphs();
+#ifdef GRAPHICMODE
+    lcd_display_block(x * sizeof(FONT[0]), y, sizeof(FONT[0]));
+    if (dirtySpan[y].min == x * sizeof(FONT[0]) && dirtySpan[y].max == (x + 1) * sizeof(FONT[0]) - 1)
+        lcd_markClean(y);
+#endif
+    lcd_goto_xpix_y(cursorX, cursorY);
+}
+#if defined TEXTMODE
+void lcd_putBitmap(uint8_t x, uint8_t y, const uint8_t picture[], uint8_t width, uint8_t pages) {
+    // page format bitmap straight from flash, cursor position is kept
+    if (x > DISPLAY_WIDTH-1 || y > DISPLAY_HEIGHT/8-1) return;
+    uint8_t columns = (x + width > DISPLAY_WIDTH) ? DISPLAY_WIDTH - x : width;
+    if (y + pages > DISPLAY_HEIGHT/8) pages = DISPLAY_HEIGHT/8 - y;
+#if defined GRAPHICBANDS
+    if (bandPage != 0xff) {
+        lcd_drawPageBitmap(x, y * 8, picture, width, pages * 8, BITMAP_OPAQUE);
+        return;
+    }
+#endif
+    uint8_t cursorX = cursorPosition.x;
+    uint8_t cursorY = cursorPosition.y;
+    for (uint8_t i = 0; i < pages; i++) {
+        lcd_goto_xpix_y(x, y + i);
+        lcd_data_p(picture + i * width, columns);
+    }
+    lcd_goto_xpix_y(cursorX, cursorY);
+}
+#endif
+void lcd_putPackedBitmap(uint8_t x, uint8_t y, const uint8_t packed[]) {
+    // width, pages, then runs of each page: control byte 0..127: 1..128 bytes follow,
+    // 128..255: next byte (control & 0x7f) + 3 times, runs end at the end of the page
+    uint8_t width = pgm_read_byte(&packed[0]);
+    uint8_t pages = pgm_read_byte(&packed[1]);
+    const uint8_t *run = packed + 2;
+    if (x > DISPLAY_WIDTH-1 || y > DISPLAY_HEIGHT/8-1 || !width) return;
+    uint8_t columns = (x + width > DISPLAY_WIDTH) ? DISPLAY_WIDTH - x : width;
+    if (y + pages > DISPLAY_HEIGHT/8) pages = DISPLAY_HEIGHT/8 - y;
+#if defined TEXTMODE
+    uint8_t cursorX = cursorPosition.x;
+    uint8_t cursorY = cursorPosition.y;
+#endif
+    for (uint8_t page = y; page < y + pages; page++) {
+        uint8_t *column = 0;    // decoded into buffer, 0: send to display
+        uint8_t skip = 0;       // page outside of band
+#if defined GRAPHICMODE
+        lcd_markDirty(page, x, x + columns - 1);
+        column = &displayBuffer[page][x];
+#elif defined TEXTMODE
+#if defined GRAPHICBANDS
+        if (bandPage != 0xff) {
+            column = &bandBuffer[x];
+            skip = (page != bandPage);
+        }
+#endif
+        if (!column) {
+            lcd_goto_xpix_y(x, page);
+            lcd_endRun();
+            lcd_beginTransmission();
+            i2c_queueByte(0x40);    // 0x00 for command, 0x40 for data
+        }
+#endif
+        for (uint8_t i = 0; i < width;) {
+            uint8_t control = pgm_read_byte(run++);
+            uint8_t count = (control & 0x80) ? (control & 0x7f) + 3 : control + 1;
+            // columns right of the display are decoded, not drawn
+            uint8_t shown = (i >= columns) ? 0 : (i + count > columns) ? columns - i : count;
+            if (control & 0x80) {
+                uint8_t data = pgm_read_byte(run++);
+                if (shown && !skip) {
+                    if (column) memset(column + i, data, shown);
+                    else i2c_queueRepeat(data, shown);
+                }
+            } else {
+                if (shown && !skip) {
+                    if (column) memcpy_P(column + i, run, shown);
+                    else i2c_queueData_p(run, shown);
+                }
+                run += count;
+            }
+            i += count;
+        }
+#if defined TEXTMODE
+        if (!column) {
+            i2c_queueStop();
+            lcd_ramAdvance(columns);
+        }
+#endif
+    }
+#if defined TEXTMODE
+    lcd_goto_xpix_y(cursorX, cursorY);
+#endif
+}
 void lcd_puts(const char* s){
+#if defined TEXTMODE
+    batchRun = 1;
+#endif
     while (*s) {
         lcd_putc((unsigned char)(*s++));
     }
+#if defined TEXTMODE
+    batchRun = 0;
+#endif
+    lcd_endRun();
 }
 void lcd_puts_p(const char* progmem_s){
     register uint8_t c;
+#if defined TEXTMODE
+    batchRun = 1;
+#endif
     while ((c = pgm_read_byte(progmem_s++))) {
         lcd_putc((unsigned char)c);
     }
+#if defined TEXTMODE
+    batchRun = 0;
+#endif
+    lcd_endRun();
 }
-#ifdef GRAPHICMODE
+#if defined GRAPHICMODE || defined GRAPHICBANDS
 #pragma mark -
 #pragma mark GRAPHIC FUNCTIONS
+// rows y1..y2 are clipped to the page of lcd_drawBands, 0: nothing to draw
+static uint8_t lcd_clipRows(uint8_t *y1, uint8_t *y2){
+#if defined GRAPHICBANDS
+    if (bandPage == 0xff) return 0;
+    uint8_t top = bandPage*8;
+    if (*y1 < top) *y1 = top;
+    if (*y2 > top+7) *y2 = top+7;
+#endif
+    return *y1 <= *y2;
+}
+static uint8_t lcd_outsideBand(int16_t y1, int16_t y2){
+    if (y1 < 0) y1 = 0;
+    if (y2 > DISPLAY_HEIGHT-1) y2 = DISPLAY_HEIGHT-1;
+    uint8_t top = y1, bottom = y2;
+    return y1 > y2 || !lcd_clipRows(&top, &bottom);
+}
 void lcd_drawPixel(uint8_t x, uint8_t y, uint8_t color){
     if( x > DISPLAY_WIDTH-1 || y > (DISPLAY_HEIGHT-1)) return; // out of Display
+#if defined GRAPHICMODE
+    lcd_markDirty(y / 8, x, x);
     if( color == WHITE){
         displayBuffer[(y / (DISPLAY_HEIGHT/8))][x] |= (1 << (y % (DISPLAY_HEIGHT/8)));
     } else {
         displayBuffer[(y / (DISPLAY_HEIGHT/8))][x] &= ~(1 << (y % (DISPLAY_HEIGHT/8)));
     }
+#else
+    if ((y / 8) != bandPage) return;    // other page
+    if( color == WHITE){
+        bandBuffer[x] |= (1 << (y % 8));
+    } else {
+        bandBuffer[x] &= ~(1 << (y % 8));
+    }
+#endif
+}
+// column x1 of page for columns x1..x2 to be changed, 0 if page isn't drawn
+static uint8_t *lcd_bufferColumns(uint8_t page, uint8_t x1, uint8_t x2){
+#if defined GRAPHICMODE
+    lcd_markDirty(page, x1, x2);
+    return &displayBuffer[page][x1];
+#else
+    (void)x2;
+    if (page != bandPage) return 0;
+    return &bandBuffer[x1];
+#endif
+}
+// columns x1..x2 of page: bits of mask are set (WHITE) or cleared
+static void lcd_fillColumns(uint8_t page, uint8_t x1, uint8_t x2, uint8_t mask, uint8_t color){
+    uint8_t *column = lcd_bufferColumns(page, x1, x2);
+    if (!column) return;
+    uint8_t count = x2 - x1 + 1;
+    if (mask == 0xff) {
+        memset(column, (color == WHITE) ? 0xff : 0x00, count);
+    } else if (color == WHITE) {
+        while (count--) *column++ |= mask;
+    } else {
+        mask = ~mask;
+        while (count--) *column++ &= mask;
+    }
+}
+void lcd_drawHLine(uint8_t x1, uint8_t x2, uint8_t y, uint8_t color){
+    if (x1 > x2) { uint8_t temp = x1; x1 = x2; x2 = temp; }
+    if (x2 > DISPLAY_WIDTH-1 || y > DISPLAY_HEIGHT-1) return;
+    lcd_fillColumns(y / 8, x1, x2, 1 << (y % 8), color);
+}
+void lcd_drawVLine(uint8_t x, uint8_t y1, uint8_t y2, uint8_t color){
+    lcd_fillRect(x, y1, x, y2, color);
 }
 void lcd_drawLine(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t color){
     if( x1 > DISPLAY_WIDTH-1 ||
        x2 > DISPLAY_WIDTH-1 ||
        y1 > DISPLAY_HEIGHT-1 ||
        y2 > DISPLAY_HEIGHT-1) return;
+    if (y1 == y2) {
+        lcd_drawHLine(x1, x2, y1, color);
+        return;
+    }
+    if (x1 == x2) {
+        lcd_drawVLine(x1, y1, y2, color);
+        return;
+    }
+    if (lcd_outsideBand(y1 < y2 ? y1 : y2, y1 < y2 ? y2 : y1)) return;
     int dx =  abs(x2-x1), sx = x1<x2 ? 1 : -1;
     int dy = -abs(y2-y1), sy = y1<y2 ? 1 : -1;
     int err = dx+dy, e2; /* error value e_xy */
@@ -426,39 +896,88 @@ void lcd_drawRect(uint8_t px1, uint8_t py1, uint8_t px2, uint8_t py2, uint8_t co
        px2 > DISPLAY_WIDTH-1 ||
        py1 > DISPLAY_HEIGHT-1 ||
        py2 > DISPLAY_HEIGHT-1) return;
-    lcd_drawLine(px1, py1, px2, py1, color);
-    lcd_drawLine(px2, py1, px2, py2, color);
-    lcd_drawLine(px2, py2, px1, py2, color);
-    lcd_drawLine(px1, py2, px1, py1, color);
+    lcd_drawHLine(px1, px2, py1, color);
+    lcd_drawVLine(px2, py1, py2, color);
+    lcd_drawHLine(px1, px2, py2, color);
+    lcd_drawVLine(px1, py1, py2, color);
 }
 void lcd_fillRect(uint8_t px1, uint8_t py1, uint8_t px2, uint8_t py2, uint8_t color){
-    if( px1 > px2){
-        uint8_t temp = px1;
-        px1 = px2;
-        px2 = temp;
-        temp = py1;
-        py1 = py2;
-        py2 = temp;
-    }
-    for (uint8_t i=0; i<=(py2-py1); i++){
-        lcd_drawLine(px1, py1+i, px2, py1+i, color);
+    if (px1 > px2) { uint8_t temp = px1; px1 = px2; px2 = temp; }
+    if (py1 > py2) { uint8_t temp = py1; py1 = py2; py2 = temp; }
+    if (px2 > DISPLAY_WIDTH-1 || py1 > DISPLAY_HEIGHT-1) return;
+    if (py2 > DISPLAY_HEIGHT-1) py2 = DISPLAY_HEIGHT-1;
+    if (!lcd_clipRows(&py1, &py2)) return;
+    // whole bytes per page, masked at first and last page
+    uint8_t lastPage = py2 / 8;
+    for (uint8_t page = py1 / 8; page <= lastPage; page++){
+        uint8_t mask = 0xff;
+        if (page == py1 / 8) mask &= (uint8_t)(0xff << (py1 % 8));
+        if (page == lastPage) mask &= (uint8_t)(0xff >> (7 - py2 % 8));
+        lcd_fillColumns(page, px1, px2, mask, color);
     }
 }
-void lcd_drawCircle(uint8_t center_x, uint8_t center_y, uint8_t radius, uint8_t color){
-    if( ((center_x + radius) > DISPLAY_WIDTH-1) ||
-       ((center_y + radius) > DISPLAY_HEIGHT-1) ||
-       center_x < radius ||
-       center_y < radius) return;
+// shapes partly outside of display are clipped
+static void lcd_clipPixel(int16_t x, int16_t y, uint8_t color){
+    if (x < 0 || y < 0 || x > DISPLAY_WIDTH-1 || y > DISPLAY_HEIGHT-1) return;
+    lcd_drawPixel(x, y, color);
+}
+static void lcd_clipVLine(int16_t x, int16_t y1, int16_t y2, uint8_t color){
+    if (x < 0 || x > DISPLAY_WIDTH-1 || y2 < 0 || y1 > DISPLAY_HEIGHT-1) return;
+    if (y1 < 0) y1 = 0;
+    if (y2 > DISPLAY_HEIGHT-1) y2 = DISPLAY_HEIGHT-1;
+    lcd_drawVLine(x, y1, y2, color);
+}
+static void lcd_clipHLine(int16_t x1, int16_t x2, int16_t y, uint8_t color){
+    if (y < 0 || y > DISPLAY_HEIGHT-1 || x2 < 0 || x1 > DISPLAY_WIDTH-1) return;
+    if (x1 < 0) x1 = 0;
+    if (x2 > DISPLAY_WIDTH-1) x2 = DISPLAY_WIDTH-1;
+    lcd_drawHLine(x1, x2, y, color);
+}
+// midpoint circle, corners: 1 top left, 2 top right, 4 bottom right, 8 bottom left
+static void lcd_drawCorners(int16_t center_x, int16_t center_y, int16_t radius, uint8_t corners, uint8_t color){
     int16_t f = 1 - radius;
     int16_t ddF_x = 1;
     int16_t ddF_y = -2 * radius;
     int16_t x = 0;
     int16_t y = radius;
     
-    lcd_drawPixel(center_x  , center_y+radius, color);
-    lcd_drawPixel(center_x  , center_y-radius, color);
-    lcd_drawPixel(center_x+radius, center_y  , color);
-    lcd_drawPixel(center_x-radius, center_y  , color);
+    while (x<y) {
+        if (f >= 0) {
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+        
+        if (corners & 4) {
+            lcd_clipPixel(center_x + x, center_y + y, color);
+            lcd_clipPixel(center_x + y, center_y + x, color);
+        }
+        if (corners & 8) {
+            lcd_clipPixel(center_x - x, center_y + y, color);
+            lcd_clipPixel(center_x - y, center_y + x, color);
+        }
+        if (corners & 2) {
+            lcd_clipPixel(center_x + x, center_y - y, color);
+            lcd_clipPixel(center_x + y, center_y - x, color);
+        }
+        if (corners & 1) {
+            lcd_clipPixel(center_x - x, center_y - y, color);
+            lcd_clipPixel(center_x - y, center_y - x, color);
+        }
+    }
+}
+// columns of a filled circle, sides: 1 right, 2 left, stretched by delta rows downwards
+static void lcd_fillSides(int16_t center_x, int16_t center_y, int16_t radius, uint8_t sides, int16_t delta, uint8_t color){
+    int16_t f = 1 - radius;
+    int16_t ddF_x = 1;
+    int16_t ddF_y = -2 * radius;
+    int16_t x = 0;
+    int16_t y = radius;
+    int16_t lastX = 0;
+    int16_t lastY = y;
     
     while (x<y) {
         if (f >= 0) {
@@ -470,24 +989,68 @@ void lcd_drawCircle(uint8_t center_x, uint8_t center_y, uint8_t radius, uint8_t
         ddF_x += 2;
         f += ddF_x;
         
-        lcd_drawPixel(center_x + x, center_y + y, color);
-        lcd_drawPixel(center_x - x, center_y + y, color);
-        lcd_drawPixel(center_x + x, center_y - y, color);
-        lcd_drawPixel(center_x - x, center_y - y, color);
-        lcd_drawPixel(center_x + y, center_y + x, color);
-        lcd_drawPixel(center_x - y, center_y + x, color);
-        lcd_drawPixel(center_x + y, center_y - x, color);
-        lcd_drawPixel(center_x - y, center_y - x, color);
+        // each column once: columns +-x while x <= y, columns +-y when y changes
+        if (x <= y) {
+            if (sides & 1) lcd_clipVLine(center_x + x, center_y - y, center_y + y + delta, color);
+            if (sides & 2) lcd_clipVLine(center_x - x, center_y - y, center_y + y + delta, color);
+        }
+        if (y != lastY) {
+            if (sides & 1) lcd_clipVLine(center_x + lastY, center_y - lastX, center_y + lastX + delta, color);
+            if (sides & 2) lcd_clipVLine(center_x - lastY, center_y - lastX, center_y + lastX + delta, color);
+            lastY = y;
+        }
+        lastX = x;
     }
 }
+void lcd_drawCircle(uint8_t center_x, uint8_t center_y, uint8_t radius, uint8_t color){
+    if (lcd_outsideBand(center_y - radius, center_y + radius)) return;
+    lcd_clipPixel(center_x  , center_y+radius, color);
+    lcd_clipPixel(center_x  , center_y-radius, color);
+    lcd_clipPixel(center_x+radius, center_y  , color);
+    lcd_clipPixel(center_x-radius, center_y  , color);
+    lcd_drawCorners(center_x, center_y, radius, 0x0f, color);
+}
 void lcd_fillCircle(uint8_t center_x, uint8_t center_y, uint8_t radius, uint8_t color) {
-    for(uint8_t i=0; i<= radius;i++){
-        lcd_drawCircle(center_x, center_y, i, color);
-    }
+    if (lcd_outsideBand(center_y - radius, center_y + radius)) return;
+    // vertical spans fill whole bytes of the pages
+    lcd_clipVLine(center_x, center_y - radius, center_y + radius, color);
+    lcd_fillSides(center_x, center_y, radius, 3, 0, color);
+}
+// radius is limited to half of width and height
+static uint8_t lcd_roundRadius(uint8_t *px1, uint8_t *py1, uint8_t *px2, uint8_t *py2, uint8_t radius){
+    if (*px1 > *px2) { uint8_t temp = *px1; *px1 = *px2; *px2 = temp; }
+    if (*py1 > *py2) { uint8_t temp = *py1; *py1 = *py2; *py2 = temp; }
+    if (radius > (*px2 - *px1) / 2) radius = (*px2 - *px1) / 2;
+    if (radius > (*py2 - *py1) / 2) radius = (*py2 - *py1) / 2;
+    return radius;
+}
+void lcd_drawRoundRect(uint8_t px1, uint8_t py1, uint8_t px2, uint8_t py2, uint8_t radius, uint8_t color){
+    radius = lcd_roundRadius(&px1, &py1, &px2, &py2, radius);
+    if (lcd_outsideBand(py1, py2)) return;
+    lcd_clipHLine(px1 + radius, px2 - radius, py1, color);
+    lcd_clipHLine(px1 + radius, px2 - radius, py2, color);
+    lcd_clipVLine(px1, py1 + radius, py2 - radius, color);
+    lcd_clipVLine(px2, py1 + radius, py2 - radius, color);
+    lcd_drawCorners(px1 + radius, py1 + radius, radius, 1, color);
+    lcd_drawCorners(px2 - radius, py1 + radius, radius, 2, color);
+    lcd_drawCorners(px2 - radius, py2 - radius, radius, 4, color);
+    lcd_drawCorners(px1 + radius, py2 - radius, radius, 8, color);
+}
+void lcd_fillRoundRect(uint8_t px1, uint8_t py1, uint8_t px2, uint8_t py2, uint8_t radius, uint8_t color){
+    radius = lcd_roundRadius(&px1, &py1, &px2, &py2, radius);
+    if (lcd_outsideBand(py1, py2)) return;
+    if (px1 > DISPLAY_WIDTH-1 || py1 > DISPLAY_HEIGHT-1) return;
+    int16_t x2 = px2 - radius;
+    if (x2 > DISPLAY_WIDTH-1) x2 = DISPLAY_WIDTH-1;
+    if (px1 + radius <= x2) lcd_fillRect(px1 + radius, py1, x2, py2, color);
+    int16_t delta = py2 - py1 - 2 * radius;
+    lcd_fillSides(px2 - radius, py1 + radius, radius, 1, delta, color);
+    lcd_fillSides(px1 + radius, py1 + radius, radius, 2, delta, color);
 }
 void lcd_drawBitmap(uint8_t x, uint8_t y, const uint8_t *picture, uint8_t width, uint8_t height, uint8_t color){
     uint8_t i,j, byteWidth = (width+7)/8;
     for (j = 0; j < height; j++) {
+        if (lcd_outsideBand(y+j, y+j)) continue;
         for(i=0; i < width;i++){
             if(pgm_read_byte(picture + j * byteWidth + i / 8) & (128 >> (i & 7))){
                 lcd_drawPixel(x+i, y+j, color);
@@ -497,32 +1060,128 @@ void lcd_drawBitmap(uint8_t x, uint8_t y, const uint8_t *picture, uint8_t width,
         }
     }
 }
-void lcd_display() {
-#if defined (SSD1306) || defined (SSD1309)
-    lcd_gotoxy(0,0);
-    lcd_data(&displayBuffer[0][0], DISPLAY_WIDTH*DISPLAY_HEIGHT/8);
-#elif defined SH1106
-    for (uint8_t i = 0; i < DISPLAY_HEIGHT/8; i++){
-        lcd_gotoxy(0,i);
-        lcd_data(displayBuffer[i], sizeof(displayBuffer[i]));
+void lcd_drawPageBitmap(uint8_t x, uint8_t y, const uint8_t picture[], uint8_t width, uint8_t height, uint8_t mode){
+    if (x > DISPLAY_WIDTH-1 || y > DISPLAY_HEIGHT-1 || !width || !height) return;
+    uint8_t y1 = y;
+    uint8_t y2 = (y + height > DISPLAY_HEIGHT) ? DISPLAY_HEIGHT-1 : y + height - 1;
+    if (!lcd_clipRows(&y1, &y2)) return;
+    uint8_t columns = (x + width > DISPLAY_WIDTH) ? DISPLAY_WIDTH - x : width;
+    uint8_t shift = y % 8;
+    uint8_t rows = (height + 7) / 8;
+    for (uint8_t page = y1 / 8; page <= y2 / 8; page++){
+        uint8_t mask = 0xff;
+        if (page == y1 / 8) mask &= (uint8_t)(0xff << (y1 % 8));
+        if (page == y2 / 8) mask &= (uint8_t)(0xff >> (7 - y2 % 8));
+        uint8_t *column = lcd_bufferColumns(page, x, x + columns - 1);
+        if (!column) continue;
+        // row of picture shifted down into the page, at unaligned y the row above shifted up
+        uint8_t row = page - y / 8;
+        const uint8_t *lower = (row < rows) ? picture + row * width : 0;
+        const uint8_t *upper = (shift && row > 0) ? picture + (row - 1) * width : 0;
+        if (!upper && mask == 0xff && mode == BITMAP_OPAQUE) {
+            memcpy_P(column, lower, columns);
+            continue;
+        }
+        for (uint8_t i = 0; i < columns; i++){
+            uint8_t bits = 0;
+            if (lower) bits = pgm_read_byte(lower + i) << shift;
+            if (upper) bits |= pgm_read_byte(upper + i) >> (8 - shift);
+            bits &= mask;
+            if (mode == BITMAP_XOR) {
+                column[i] ^= bits;
+            } else if (mode == BITMAP_TRANSPARENT) {
+                column[i] |= bits;
+            } else {
+                column[i] = (column[i] & ~mask) | bits;
+            }
+        }
     }
+}
+#if defined GRAPHICBANDS
+void lcd_drawBands(void (*draw)(void)){
+    // each page is drawn in bandBuffer and send while the next is drawn
+    uint8_t x = cursorPosition.x;
+    uint8_t y = cursorPosition.y;
+    for (uint8_t page = 0; page < DISPLAY_HEIGHT/8; page++){
+        memset(bandBuffer, 0x00, sizeof(bandBuffer));
+        bandPage = page;
+        lcd_goto_xpix_y(x, y);      // text starts at the same position for each page
+        draw();
+        bandPage = 0xff;
+        lcd_gotoxy(0, page);
+        lcd_data(bandBuffer, sizeof(bandBuffer));
+    }
+    lcd_goto_xpix_y(x, y);
+}
 #endif
+#if defined GRAPHICMODE
+void lcd_display() {
+    // rest of a frame started by lcd_displayStep(), then changes since
+    if (framePage < DISPLAY_HEIGHT/8) lcd_displayStep(0xffff);
+    lcd_displayStep(0xffff);
+}
+uint8_t lcd_displayStep(uint16_t budget) {
+    if (framePage == DISPLAY_HEIGHT/8) {
+        // frame of the columns changed up to now, only the columns are kept:
+        // they are read from the buffer when their page is send, so drawing into
+        // pages not send yet goes out with this frame, other columns with the next
+        memcpy(frameSpan, dirtySpan, sizeof(frameSpan));
+        for (uint8_t i = 0; i < DISPLAY_HEIGHT/8; i++) lcd_markClean(i);
+        framePage = 0;
+    }
+    // send only changed columns of each page
+    while (framePage < DISPLAY_HEIGHT/8) {
+        uint8_t min = frameSpan[framePage].min;
+        if (min > frameSpan[framePage].max) {
+            framePage++;
+            continue;
+        }
+        if (!budget) return 0;
+        uint16_t width = frameSpan[framePage].max - min + 1;
+        if (width > budget) width = budget;
+        lcd_display_block(min, framePage, width);
+        frameSpan[framePage].min = min + width;
+        budget -= width;
+    }
+    return 1;
 }
 void lcd_clear_buffer() {
+    generation++;
     for (uint8_t i = 0; i < DISPLAY_HEIGHT/8; i++){
         memset(displayBuffer[i], 0x00, sizeof(displayBuffer[i]));
+        lcd_markDirty(i, 0, DISPLAY_WIDTH-1);
     }
 }
 uint8_t lcd_check_buffer(uint8_t x, uint8_t y) {
     if( x > DISPLAY_WIDTH-1 || y > (DISPLAY_HEIGHT-1)) return 0; // out of Display
     return displayBuffer[(y / (DISPLAY_HEIGHT/8))][x] & (1 << (y % (DISPLAY_HEIGHT/8)));
 }
+void lcd_read_buffer(uint8_t x, uint8_t line, uint8_t width, uint8_t data[]) {
+    if (line > (DISPLAY_HEIGHT/8-1) || x > DISPLAY_WIDTH - 1) return;
+    if (x + width > DISPLAY_WIDTH) width = DISPLAY_WIDTH - x;
+    memcpy(data, &displayBuffer[line][x], width);
+}
+void lcd_write_buffer(uint8_t x, uint8_t line, uint8_t width, const uint8_t data[]) {
+    if (line > (DISPLAY_HEIGHT/8-1) || x > DISPLAY_WIDTH - 1) return;
+    if (x + width > DISPLAY_WIDTH) width = DISPLAY_WIDTH - x;
+    // only changed columns are send by lcd_display()
+    uint8_t *column = &displayBuffer[line][x];
+    uint8_t first = 0;
+    while (first < width && column[first] == data[first]) first++;
+    if (first == width) return;
+    uint8_t last = width - 1;
+    while (column[last] == data[last]) last--;
+    memcpy(column + first, data + first, last - first + 1);
+    lcd_markDirty(line, x + first, x + last);
+}
 void lcd_display_block(uint8_t x, uint8_t line, uint8_t width) {
     if (line > (DISPLAY_HEIGHT/8-1) || x > DISPLAY_WIDTH - 1){return;}
     if (x + width > DISPLAY_WIDTH) { // no -1 here, x alone is width 1
         width = DISPLAY_WIDTH - x;
     }
     lcd_goto_xpix_y(x,line);
-    lcd_data(&displayBuffer[line][x], width);
+    // buffer is read at transmission, columns changed meanwhile are send again
+    lcd_data_r(&displayBuffer[line][x], width);
 }
 #endif
+#endif
@@ -62,6 +62,8 @@ extern "C" {
 /* TODO: define displaymode */
 #define TEXTMODE        // TEXTMODE for only text to display,
             // GRAPHICMODE for text and graphic
+//#define GRAPHICBANDS  // at TEXTMODE: graphic drawn page by page by lcd_drawBands(),
+            // one page of SRAM instead of the buffer of GRAPHICMODE
 /* TODO: define font */
 #define FONT      ssd1306oled_font// set font here, refer font-name at font.h/font.c
 
@@ -106,6 +108,10 @@ extern "C" {
 #define WHITE      0x01
 #define BLACK      0x00
 
+#define BITMAP_OPAQUE       0   // set and clear pixels (lcd_drawPageBitmap)
+#define BITMAP_TRANSPARENT  1   // set pixels only
+#define BITMAP_XOR          2   // invert pixels
+
 #define DISPLAY_WIDTH    128
 #define DISPLAY_HEIGHT    64
 
@@ -113,8 +119,22 @@ extern "C" {
 
 void lcd_command(uint8_t cmd[], uint8_t size);  // transmit command to display
 void lcd_data(uint8_t data[], uint16_t size);  // transmit data to display
+void lcd_data_r(const uint8_t data[], uint16_t size);  // transmit data to display, at I2C_ASYNC
+            // read from ram at transmission: keep it until i2c_busy() is 0
+void lcd_data_repeat(uint8_t data, uint16_t size);  // transmit same data size times to display
+void lcd_data_p(const uint8_t progmem_data[], uint16_t size);  // transmit data from flash to display
+#if defined I2C
+void lcd_data_start(void);  // start data transmission at cursor position,
+            // queue data with i2c_queueByte() etc., end with i2c_queueStop()
+#endif
 void lcd_init(uint8_t dispAttr);
+void lcd_reinit(uint8_t dispAttr);            // init of a reconnected display, GRAPHICMODE: buffer is
+            // kept and send again by lcd_display(), TEXTMODE: same as lcd_init
 void lcd_home(void);                          // set cursor to 0,0
+void lcd_scrollUp(void);                      // scroll up one line (display start line), clear last line
+void lcd_consoleMode(uint8_t on);             // YES: '\n' at last line scrolls up
+uint8_t lcd_generation(void);                 // changes with lcd_init, lcd_clrscr, lcd_scrollUp
+            // and lcd_clear_buffer: text written before is gone or moved
 void lcd_invert(uint8_t invert);    // invert display
 void lcd_sleep(uint8_t sleep);      // display goto sleep (power off)
 void lcd_set_contrast(uint8_t contrast);  // set contrast for display
@@ -126,24 +146,68 @@ void lcd_puts_p(const char* progmem_s);    // print string from flash on screen
 void lcd_clrscr(void);        // clear screen (and buffer at GRFAICMODE)
 void lcd_gotoxy(uint8_t x, uint8_t y);    // set curser at pos x, y. x means character,
 // y means line (page, refer lcd manual)
+void lcd_get_xpix_y(uint8_t *x, uint8_t *y); // cursor position, x means pixel
 void lcd_goto_xpix_y(uint8_t x, uint8_t y); // set curser at pos x, y. x means pixel,
 // y means line (page, refer lcd manual)
+uint16_t lcd_skippedCommands(void);  // count of position commands not send,
+            // display was already at the position
 void lcd_putc(unsigned char c);        // print character on screen at TEXTMODE
             // at GRAPHICMODE print character to buffer
 void lcd_charMode(uint8_t mode);            // set size of chars
 uint8_t lcd_charReadAndFormat(unsigned char c, uint8_t i);
-#if defined GRAPHICMODE
+uint8_t lcd_charIndex(unsigned char c);     // index of char in font, 0xff if not in font
+void lcd_putGlyph(uint8_t glyph, uint8_t mode); // print glyph (index in font) with mode (UNDERLINE, INVERT),
+            // at TEXTMODE following glyphs are send in one transmission
+void lcd_putGlyphColumns(uint8_t glyph, uint8_t mode, uint8_t first, uint8_t last); // print columns first..last of glyph
+void lcd_endGlyphs(void);                   // end transmission of glyphs (TEXTMODE)
+uint8_t lcd_glyphColumn(uint8_t glyph, uint8_t i, uint8_t mode); // column i of glyph with mode
+void lcd_overlayGlyph(uint8_t x, uint8_t y, uint8_t glyph, uint8_t mode); // glyph at char x, y is send at once,
+                                            // cursor position is kept
+#if defined TEXTMODE
+void lcd_putBitmap(uint8_t x, uint8_t y, const uint8_t picture[], uint8_t width, uint8_t pages); // bitmap in page format
+            // (refer lcd_drawPageBitmap) from flash at pixel x, line y, cursor position is kept
+#endif
+void lcd_putPackedBitmap(uint8_t x, uint8_t y, const uint8_t packed[]); // run-length coded bitmap in page format
+            // from flash (Host/bitmap2c.py -p) at pixel x, line y, decoded while send (TEXTMODE)
+            // or into buffer (GRAPHICMODE)
+#if defined GRAPHICBANDS && !defined TEXTMODE
+#error "GRAPHICBANDS needs TEXTMODE! Refer lcd.h"
+#endif
+#if defined GRAPHICMODE || defined GRAPHICBANDS
+// at GRAPHICBANDS only inside the draw function of lcd_drawBands()
 void lcd_drawPixel(uint8_t x, uint8_t y, uint8_t color);
 void lcd_drawLine(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t color);
+void lcd_drawHLine(uint8_t x1, uint8_t x2, uint8_t y, uint8_t color);   // line of row y, columns x1..x2
+void lcd_drawVLine(uint8_t x, uint8_t y1, uint8_t y2, uint8_t color);   // line of column x, rows y1..y2
 void lcd_drawRect(uint8_t px1, uint8_t py1, uint8_t px2, uint8_t py2, uint8_t color);
 void lcd_fillRect(uint8_t px1, uint8_t py1, uint8_t px2, uint8_t py2, uint8_t color);
 void lcd_drawCircle(uint8_t center_x, uint8_t center_y, uint8_t radius, uint8_t color);
 void lcd_fillCircle(uint8_t center_x, uint8_t center_y, uint8_t radius, uint8_t color);
+void lcd_drawRoundRect(uint8_t px1, uint8_t py1, uint8_t px2, uint8_t py2, uint8_t radius, uint8_t color);
+void lcd_fillRoundRect(uint8_t px1, uint8_t py1, uint8_t px2, uint8_t py2, uint8_t radius, uint8_t color);
 void lcd_drawBitmap(uint8_t x, uint8_t y, const uint8_t picture[], uint8_t width, uint8_t height, uint8_t color);
+void lcd_drawPageBitmap(uint8_t x, uint8_t y, const uint8_t picture[], uint8_t width, uint8_t height, uint8_t mode);
+            // picture from flash in page format of the display: (height+7)/8 rows of width bytes,
+            // bit 0 is the top pixel, Host/bitmap2c.py converts images
+#endif
+#if defined GRAPHICBANDS
+void lcd_drawBands(void (*draw)(void)); // draw is called once per page with graphic functions and
+            // text (lcd_putc, lcd_puts...), the page is send after each call
+#endif
+#if defined GRAPHICMODE
 void lcd_display(void);        // copy buffer to display RAM
+uint8_t lcd_displayStep(uint16_t budget); // send at most budget bytes of changed buffer, returns 1
+            // when frame is complete, next call starts a frame with the changes since;
+            // a frame keeps the changed columns only, their content is read when send: drawing
+            // while the frame runs may show partly, hold it until 1 is returned for a whole image;
+            // with I2C_ASYNC a budget below I2C_QUEUE_BYTES returns without waiting while the bus keeps up
 void lcd_clear_buffer(void); // clear display buffer
 uint8_t lcd_check_buffer(uint8_t x, uint8_t y); // read a pixel value from the display buffer
 void lcd_display_block(uint8_t x, uint8_t line, uint8_t width); // display (part of) a display line
+void lcd_read_buffer(uint8_t x, uint8_t line, uint8_t width, uint8_t data[]); // copy (part of) a display line
+            // from buffer
+void lcd_write_buffer(uint8_t x, uint8_t line, uint8_t width, const uint8_t data[]); // copy data into (part of)
+            // a display line of buffer, only changed columns are send by lcd_display()
 #endif
 
 #ifdef __cplusplus